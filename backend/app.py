@@ -14,6 +14,7 @@ from flask_limiter import Limiter
 from flask_limiter.util import get_remote_address
 from datetime import datetime
 from pyicloud import PyiCloudService
+from pyicloud.exceptions import PyiCloudException, PyiCloudAPIResponseException
 
 # Import auth functions
 from auth_service import (
@@ -23,8 +24,28 @@ from auth_service import (
     close_db,
     create_user,
     authenticate_user,
+    update_apple_credentials,
+    credential_cache,
+    revoke_token,
+    token_cache,
     generate_token
 )
+from db_config import PoolExhausted
+from rate_limit import MEMORY_STORAGE_URI, limit_processes, limiter_options, per_process_limit
+from session_pool import ICloudSessionPool
+from reminder_cache import (
+    ReminderCache,
+    collection_ctag,
+    CACHE_HIT,
+    CACHE_MISS,
+    CACHE_REVALIDATED,
+    CACHE_STALE
+)
+from background_refresh import BackgroundRefresher
+from singleflight import Group
+from change_feed import ChangeFeed, encode_cursor, decode_cursor
+from reminder_index import ReminderIndexRegistry
+from http_cache import strong_etag, version_etag, if_none_match, choose_encoding, compress
 
 # Configure logging
 logging.basicConfig(
@@ -58,17 +79,73 @@ if FLASK_ENV == 'production':
 else:
     logger.warning("Running in DEVELOPMENT mode")
 
-# Rate limiting
+# Rate limiting. Point RATELIMIT_STORAGE_URI (or REDIS_URL) at a shared
+# Redis/Valkey store so all workers and instances count together. Without
+# one, each of the WEB_CONCURRENCY worker processes enforces its share of
+# every limit.
+RATELIMIT_STORAGE_URI = os.environ.get('RATELIMIT_STORAGE_URI') or os.environ.get('REDIS_URL') or MEMORY_STORAGE_URI
+# moving-window is a true sliding window; on Redis each hit is checked and
+# recorded in one atomic script
+RATELIMIT_STRATEGY = os.environ.get('RATELIMIT_STRATEGY', 'moving-window')
+RATELIMIT_PROCESSES = limit_processes(RATELIMIT_STORAGE_URI, int(os.environ.get('WEB_CONCURRENCY', 1)))
+
+
+def rate_limit(limit):
+    """This process's share of limit"""
+    return per_process_limit(limit, RATELIMIT_PROCESSES)
+
+
 limiter = Limiter(
     app=app,
     key_func=get_remote_address,
-    default_limits=["200 per day", "50 per hour"],
-    storage_uri="memory://"
+    default_limits=[rate_limit("200 per day"), rate_limit("50 per hour")],
+    key_prefix='pebble-icloud',
+    **limiter_options(RATELIMIT_STORAGE_URI, RATELIMIT_STRATEGY)
 )
+if RATELIMIT_PROCESSES > 1:
+    logger.warning(f"Rate limits split across {RATELIMIT_PROCESSES} worker processes; "
+                   "set RATELIMIT_STORAGE_URI to share them")
+
+# iCloud session pool
+SESSION_POOL_SIZE = int(os.environ.get('ICLOUD_SESSION_POOL_SIZE', 100))
+SESSION_IDLE_TTL = int(os.environ.get('ICLOUD_SESSION_IDLE_TTL', 900))
+SESSION_DIR = os.environ.get('ICLOUD_SESSION_DIR', os.path.join(os.getcwd(), '.icloud_sessions'))
+
+# Reminder cache: entries younger than this many seconds skip iCloud entirely
+REMINDER_CACHE_MAX_STALENESS = int(os.environ.get('REMINDER_CACHE_MAX_STALENESS', 30))
+# ...and for this many seconds more they are served while a refresh runs
+REMINDER_CACHE_STALE_WHILE_REVALIDATE = int(os.environ.get('REMINDER_CACHE_STALE_WHILE_REVALIDATE', 300))
+reminder_cache = ReminderCache(
+    max_staleness=REMINDER_CACHE_MAX_STALENESS,
+    stale_while_revalidate=REMINDER_CACHE_STALE_WHILE_REVALIDATE
+)
+# Concurrent identical iCloud reads share one upstream call
+icloud_calls = Group()
+background_refresher = BackgroundRefresher(max_workers=int(os.environ.get('BACKGROUND_REFRESH_WORKERS', 4)))
+reminder_indexes = ReminderIndexRegistry()
+change_feed = ChangeFeed(max_log_entries=int(os.environ.get('CHANGE_FEED_MAX_ENTRIES', 1000)))
+
+# Reminder reads smaller than this are sent uncompressed
+RESPONSE_COMPRESSION_MIN_BYTES = int(os.environ.get('RESPONSE_COMPRESSION_MIN_BYTES', 512))
 
 # Setup teardown handlers
 app.teardown_appcontext(close_db)
 
+
+@app.errorhandler(PoolExhausted)
+def database_busy(error):
+    """
+    Every pooled connection stayed checked out; ask the client to retry.
+    Routes re-raise PoolExhausted past their generic error handling so it
+    ends up here.
+    """
+    logger.warning(f"Database pool exhausted: {error}")
+    response = jsonify({"error": "Server busy, please retry"})
+    response.status_code = 503
+    response.headers['Retry-After'] = '1'
+    return response
+
+
 # Initialize database when module is loaded (for gunicorn)
 with app.app_context():
     init_db()
@@ -89,7 +166,7 @@ def validate_username(username):
 
 # Auth endpoints
 @app.route('/api/auth/register', methods=['POST'])
-@limiter.limit("10 per hour")
+@limiter.limit(rate_limit("10 per hour"))
 def register():
     """Register a new user"""
     try:
@@ -131,13 +208,15 @@ def register():
             "user_id": user_id
         }), 201
 
+    except PoolExhausted:
+        raise
     except Exception as e:
         logger.error(f"Registration error: {str(e)}")
         return jsonify({"error": "Internal server error"}), 500
 
 
 @app.route('/api/auth/login', methods=['POST'])
-@limiter.limit("5 per minute")
+@limiter.limit(rate_limit("5 per minute"))
 def login():
     """Login user (rate limited to prevent brute force)"""
     try:
@@ -168,13 +247,96 @@ def login():
             "user_id": user['id']
         }), 200
 
+    except PoolExhausted:
+        raise
     except Exception as e:
         logger.error(f"Login error: {str(e)}")
         return jsonify({"error": "Internal server error"}), 500
 
 
+@app.route('/api/auth/logout', methods=['POST'])
+@require_auth
+def logout():
+    """Revoke the token used for this request"""
+    try:
+        revoke_token(g.token)
+        logger.info(f"User {g.user_id} logged out")
+        return jsonify({"success": True}), 200
+
+    except PoolExhausted:
+        raise
+    except Exception as e:
+        logger.error(f"Logout error: {str(e)}")
+        return jsonify({"error": "Internal server error"}), 500
+
+
+@app.route('/api/auth/credentials', methods=['PUT'])
+@limiter.limit(rate_limit("5 per minute"))
+@require_auth
+def update_credentials():
+    """Replace the stored Apple ID and app-specific password"""
+    try:
+        data = request.json
+        if not data:
+            return jsonify({"error": "Request body must be JSON"}), 400
+
+        apple_id = data.get('apple_id')
+        apple_password = data.get('apple_password')
+
+        if not apple_id or not apple_password:
+            return jsonify({"error": "apple_id and apple_password are required"}), 400
+
+        if not validate_email(apple_id):
+            return jsonify({"error": "Apple ID must be a valid email address"}), 400
+
+        if len(apple_password) < 8:
+            return jsonify({"error": "Password must be at least 8 characters"}), 400
+
+        if not update_apple_credentials(g.user_id, apple_id, apple_password):
+            return jsonify({"error": "User not found"}), 404
+
+        # The pooled session fingerprint no longer matches, but drop it now
+        # rather than on the next request. Cached lists, reminders and change
+        # tokens may belong to the previous Apple ID.
+        session_pool.invalidate(g.user_id)
+        reminder_cache.invalidate_user(g.user_id)
+        change_feed.forget(g.user_id)
+        reminder_indexes.forget(g.user_id)
+        logger.info(f"Apple credentials updated for user {g.user_id}")
+
+        return jsonify({"success": True}), 200
+
+    except PoolExhausted:
+        raise
+    except Exception as e:
+        logger.error(f"Credential update error: {str(e)}")
+        return jsonify({"error": "Internal server error"}), 500
+
+
+def create_icloud_service(apple_id, apple_password, cookie_directory=None):
+    """Log in to iCloud, reusing the per-user cookie directory when given"""
+    icloud = PyiCloudService(apple_id, apple_password, cookie_directory=cookie_directory)
+
+    # Check if 2FA is required
+    if icloud.requires_2fa:
+        logger.warning("2FA required for iCloud login")
+        # In a production system, you'd need a way to handle this
+        # For now, we'll raise an error
+        raise Exception("Two-factor authentication required. Please authenticate via the web interface.")
+
+    return icloud
+
+
+session_pool = ICloudSessionPool(
+    create_icloud_service,
+    max_size=SESSION_POOL_SIZE,
+    idle_ttl=SESSION_IDLE_TTL,
+    cookie_root=SESSION_DIR
+)
+
+
 def get_icloud_service_for_user(user_id):
-    """Get or create iCloud service instance for a specific user"""
+    """Get pooled iCloud service instance for a specific user"""
     # Get user credentials from database
     credentials = get_user_credentials(user_id)
 
@@ -185,21 +347,23 @@ def get_icloud_service_for_user(user_id):
     apple_password = credentials['apple_password']
 
     try:
-        icloud = PyiCloudService(apple_id, apple_password)
-
-        # Check if 2FA is required
-        if icloud.requires_2fa:
-            logger.warning(f"2FA required for user {user_id}")
-            # In a production system, you'd need a way to handle this
-            # For now, we'll raise an error
-            raise Exception("Two-factor authentication required. Please authenticate via the web interface.")
-
-        return icloud
+        return session_pool.get(user_id, apple_id, apple_password)
     except Exception as e:
         logger.error(f"Failed to create iCloud service for user {user_id}: {e}")
         raise
 
 
+# iCloud answers these when the session needs a fresh login
+SESSION_ERROR_CODES = {401, 403, 421, 450}
+
+
+def is_session_error(error):
+    """True for failures a fresh iCloud login may fix, not data errors"""
+    if isinstance(error, PyiCloudAPIResponseException):
+        return getattr(error, 'code', None) in SESSION_ERROR_CODES
+    return isinstance(error, PyiCloudException)
+
+
 @app.route('/health', methods=['GET'])
 def health_check():
     """Health check endpoint"""
@@ -211,60 +375,350 @@ def health_check():
     })
 
 
+@app.route('/metrics', methods=['GET'])
+def metrics():
+    """Internal counters for session reuse"""
+    return jsonify({
+        "timestamp": datetime.now().isoformat(),
+        "sessions": session_pool.stats(),
+        "reminder_cache": reminder_cache.stats(),
+        "background_refresh": background_refresher.stats(),
+        "coalesced_calls": icloud_calls.stats(),
+        "credential_cache": credential_cache.stats(),
+        "verified_tokens": token_cache.stats()
+    })
+
+
+def serialize_reminder(reminder):
+    """Convert an iCloud reminder into the API representation"""
+    return {
+        "id": reminder.get('guid'),
+        "title": reminder.get('title'),
+        "description": reminder.get('description', ''),
+        "completed": reminder.get('completed', False),
+        "due_date": reminder.get('dueDate'),
+        "priority": reminder.get('priority', 0)
+    }
+
+
+REMINDER_FIELDS = ('id', 'title', 'description', 'completed', 'due_date', 'priority')
+MAX_PAGE_SIZE = 500
+
+
+class BadRequest(Exception):
+    """Raised for an invalid query parameter; the message is returned as-is"""
+
+
+def parse_fields(value):
+    """Parse a fields= projection, or None to return every field"""
+    if not value:
+        return None
+    fields = [field.strip() for field in value.split(',') if field.strip()]
+    unknown = [field for field in fields if field not in REMINDER_FIELDS]
+    if unknown or not fields:
+        raise BadRequest(f"Unknown fields: {', '.join(unknown) or value}")
+    return fields
+
+
+def project_reminders(reminders, fields):
+    if fields is None:
+        return reminders
+    return [{field: reminder.get(field) for field in fields} for reminder in reminders]
+
+
+def parse_limit(value):
+    if value is None:
+        return None
+    try:
+        limit = int(value)
+    except ValueError:
+        raise BadRequest("limit must be an integer")
+    if limit < 1 or limit > MAX_PAGE_SIZE:
+        raise BadRequest(f"limit must be between 1 and {MAX_PAGE_SIZE}")
+    return limit
+
+
+def cached_json(payload, cache_status):
+    """JSON response tagged with how the reminder cache served it"""
+    reminder_cache.record(cache_status)
+    response = jsonify(payload)
+    response.headers['Cache-Status'] = cache_status
+    return response
+
+
+def not_modified(version, cache_status, variant):
+    """
+    Tag a reminder read from the content version its body will be built
+    from, before building it. Returns a 304 response when the client
+    already holds that representation, so the caller can skip the work;
+    otherwise None, and conditional_response puts the tag on the full body.
+    The tag depends only on the list's content, so it holds on any worker.
+    """
+    g.etag = version_etag(version, f"{request.endpoint}:{variant}")
+    if not if_none_match(request.headers.get('If-None-Match'), g.etag):
+        return None
+    reminder_cache.record(cache_status)
+    response = app.response_class(status=304)
+    response.headers['Cache-Status'] = cache_status
+    return response
+
+
+# Reminder reads answered with an ETag, and a 304 when it still matches
+CONDITIONAL_ENDPOINTS = {'get_reminder_lists', 'get_reminders', 'get_reminder_changes'}
+
+
+@app.after_request
+def conditional_response(response):
+    """
+    Tag reminder reads with an ETag, reply 304 when the client already has
+    it, and otherwise compress the body if the client accepts gzip or
+    deflate. Most refreshes from the watch change nothing. Reads that set a
+    version tag through not_modified keep it; others get a strong ETag of
+    their body.
+    """
+    version_tag = g.pop('etag', None)
+    if (request.method != 'GET' or request.endpoint not in CONDITIONAL_ENDPOINTS
+            or response.status_code not in (200, 304) or response.direct_passthrough):
+        return response
+
+    # Responses are per user, and must be revalidated before reuse
+    response.headers['Cache-Control'] = 'private, no-cache'
+    response.vary.add('Accept-Encoding')
+    if response.status_code == 304:
+        # Already answered by not_modified
+        if version_tag:
+            response.headers['ETag'] = version_tag
+        return response
+
+    body = response.get_data()
+    encoding = None
+    if len(body) >= RESPONSE_COMPRESSION_MIN_BYTES:
+        encoding = choose_encoding(request.headers.get('Accept-Encoding'))
+
+    etag = version_tag or strong_etag(body, encoding)
+    response.headers['ETag'] = etag
+
+    if if_none_match(request.headers.get('If-None-Match'), etag):
+        response.status_code = 304
+        response.set_data(b'')
+        del response.headers['Content-Length']
+        return response
+
+    if encoding:
+        response.set_data(compress(body, encoding))
+        response.headers['Content-Encoding'] = encoding
+    return response
+
+
 @app.route('/api/reminders/lists', methods=['GET'])
 @require_auth
 def get_reminder_lists():
     """Get all reminder lists for authenticated user"""
     try:
         user_id = g.user_id
-        service = get_icloud_service_for_user(user_id)
-        lists = []
+        cached = reminder_cache.get_lists(user_id)
+        if reminder_cache.is_fresh(cached):
+            return cached_json({"lists": cached.data}, CACHE_HIT)
 
-        for collection in service.reminders.collections:
-            lists.append({
-                "id": collection.guid,
-                "title": collection.title,
-                "color": getattr(collection, 'color', None)
-            })
+        if reminder_cache.is_servable_stale(cached):
+            schedule_refresh((user_id, 'lists'), refresh_lists, user_id)
+            return cached_json({"lists": cached.data}, CACHE_STALE)
 
-        return jsonify({"lists": lists})
+        lists = icloud_calls.do((user_id, 'lists'), refresh_lists, user_id)
+        return cached_json({"lists": lists}, CACHE_MISS)
+    except PoolExhausted:
+        raise
     except Exception as e:
         logger.error(f"Error fetching reminder lists: {str(e)}")
+        # Drop the pooled session if it has expired upstream
+        if is_session_error(e):
+            session_pool.invalidate(g.user_id)
         return jsonify({"error": str(e)}), 500
 
 
+def refresh_lists(user_id):
+    """Fetch a user's lists from iCloud and store them in the cache"""
+    service = get_icloud_service_for_user(user_id)
+    lists = []
+    ctags = {}
+
+    for collection in service.reminders.collections:
+        lists.append({
+            "id": collection.guid,
+            "title": collection.title,
+            "color": getattr(collection, 'color', None)
+        })
+        ctags[collection.guid] = collection_ctag(collection)
+
+    # Drops cached reminders for lists whose ctag moved
+    reminder_cache.store_lists(user_id, lists, ctags)
+    return lists
+
+
+def schedule_refresh(key, fn, *args):
+    """
+    Run a cache refresh off the request path. key starts with the user_id;
+    only one refresh per key runs at a time, and requests that miss the
+    cache meanwhile wait for it instead of starting their own.
+    """
+    def run():
+        with app.app_context():
+            try:
+                icloud_calls.do(key, fn, *args)
+            except Exception as e:
+                # A deleted list is no reason to log in again
+                if is_session_error(e):
+                    session_pool.invalidate(key[0])
+                raise
+
+    background_refresher.schedule(key, run)
+
+
+class ListNotFound(Exception):
+    """Raised when a reminder list does not exist for the user"""
+
+
+def load_reminders(user_id, list_id):
+    """
+    Return (reminders, cache_status) for a list, going to iCloud only when
+    the cached copy is stale and its collection ctag has moved. A copy
+    within the stale-while-revalidate window is returned as is and
+    refreshed in the background.
+    """
+    cached = reminder_cache.get_reminders(user_id, list_id)
+    if reminder_cache.is_fresh(cached):
+        return cached.data, CACHE_HIT
+
+    if reminder_cache.is_servable_stale(cached):
+        schedule_refresh((user_id, 'reminders', list_id), refresh_reminders, user_id, list_id)
+        return cached.data, CACHE_STALE
+
+    return icloud_calls.do((user_id, 'reminders', list_id), refresh_reminders, user_id, list_id)
+
+
+def refresh_reminders(user_id, list_id):
+    """Revalidate or refetch a list's reminders from iCloud"""
+    cached = reminder_cache.get_reminders(user_id, list_id)
+    service = get_icloud_service_for_user(user_id)
+    index = reminder_indexes.get(user_id, service)
+
+    collection = index.collection(list_id)
+    if not collection:
+        raise ListNotFound(list_id)
+
+    # An unchanged ctag means the cached reminders are still current
+    ctag = collection_ctag(collection)
+    if cached is not None and ctag is not None and cached.ctag == ctag:
+        cached.touch()
+        return cached.data, CACHE_REVALIDATED
+
+    reminders = [serialize_reminder(reminder) for reminder in index.reminders(collection)]
+    reminder_cache.store_reminders(user_id, list_id, reminders, ctag)
+    return reminders, CACHE_MISS
+
+
 @app.route('/api/reminders/list/<list_id>', methods=['GET'])
 @require_auth
 def get_reminders(list_id):
-    """Get reminders from a specific list for authenticated user"""
+    """
+    Get reminders from a specific list for authenticated user.
+    Supports limit/cursor pagination and a fields= projection.
+    """
     try:
+        fields = parse_fields(request.args.get('fields'))
+        limit = parse_limit(request.args.get('limit'))
+        cursor = request.args.get('cursor')
+
         user_id = g.user_id
-        service = get_icloud_service_for_user(user_id)
+        reminders, cache_status = load_reminders(user_id, list_id)
+        sync_token = change_feed.observe(user_id, list_id, reminders)
+        unchanged = not_modified(sync_token, cache_status, f"{fields}:{limit}:{cursor}")
+        if unchanged:
+            return unchanged
+
+        offset = 0
+        if cursor:
+            try:
+                offset = decode_cursor(cursor, sync_token)
+            except ValueError:
+                raise BadRequest("Invalid cursor")
+            if offset is None:
+                return jsonify({"error": "List changed, restart pagination"}), 409
+
+        end = len(reminders) if limit is None else min(offset + limit, len(reminders))
+        payload = {
+            "reminders": project_reminders(reminders[offset:end], fields),
+            "total": len(reminders),
+            "sync_token": sync_token,
+            "next_cursor": encode_cursor(end, sync_token) if end < len(reminders) else None
+        }
+        return cached_json(payload, cache_status)
+    except BadRequest as e:
+        return jsonify({"error": str(e)}), 400
+    except ListNotFound:
+        return jsonify({"error": "List not found"}), 404
+    except PoolExhausted:
+        raise
+    except Exception as e:
+        logger.error(f"Error fetching reminders: {str(e)}")
+        if is_session_error(e):
+            session_pool.invalidate(g.user_id)
+        return jsonify({"error": str(e)}), 500
 
-        # Find the collection
-        collection = None
-        for col in service.reminders.collections:
-            if col.guid == list_id:
-                collection = col
-                break
 
-        if not collection:
-            return jsonify({"error": "List not found"}), 404
+@app.route('/api/reminders/changes', methods=['GET'])
+@require_auth
+def get_reminder_changes():
+    """
+    Get reminders added, modified, completed or deleted in a list since a
+    sync token. Without a usable token the full list is returned with
+    reset set, and the client should replace its copy.
+    """
+    try:
+        list_id = request.args.get('list_id')
+        since = request.args.get('since')
+        fields = parse_fields(request.args.get('fields'))
 
-        reminders = []
-        for reminder in collection:
-            reminders.append({
-                "id": reminder.get('guid'),
-                "title": reminder.get('title'),
-                "description": reminder.get('description', ''),
-                "completed": reminder.get('completed', False),
-                "due_date": reminder.get('dueDate'),
-                "priority": reminder.get('priority', 0)
-            })
+        if not list_id:
+            return jsonify({"error": "list_id is required"}), 400
 
-        return jsonify({"reminders": reminders})
+        user_id = g.user_id
+        reminders, cache_status = load_reminders(user_id, list_id)
+        token = change_feed.observe(user_id, list_id, reminders)
+        # A client holding this version has nothing to apply, whichever
+        # token it sends as since
+        unchanged = not_modified(token, cache_status, fields)
+        if unchanged:
+            return unchanged
+        changes = change_feed.changes_since(user_id, list_id, since)
+
+        if changes is None:
+            payload = {
+                "reset": True,
+                "token": token,
+                "changes": [],
+                "reminders": project_reminders(reminders, fields)
+            }
+        else:
+            if fields is not None:
+                changes = [
+                    dict(change, reminder=project_reminders([change['reminder']], fields)[0])
+                    if 'reminder' in change else change
+                    for change in changes
+                ]
+            payload = {"reset": False, "token": token, "changes": changes}
+
+        return cached_json(payload, cache_status)
+    except BadRequest as e:
+        return jsonify({"error": str(e)}), 400
+    except ListNotFound:
+        return jsonify({"error": "List not found"}), 404
+    except PoolExhausted:
+        raise
     except Exception as e:
-        logger.error(f"Error fetching reminders: {str(e)}")
+        logger.error(f"Error fetching reminder changes: {str(e)}")
+        if is_session_error(e):
+            session_pool.invalidate(g.user_id)
         return jsonify({"error": str(e)}), 500
 
 
@@ -284,18 +738,15 @@ def create_reminder():
         if not list_id or not title:
             return jsonify({"error": "list_id and title are required"}), 400
 
-        # Find the collection
-        collection = None
-        for col in service.reminders.collections:
-            if col.guid == list_id:
-                collection = col
-                break
-
+        index = reminder_indexes.get(user_id, service)
+        collection = index.collection(list_id)
         if not collection:
             return jsonify({"error": "List not found"}), 404
 
         # Create reminder
         reminder = collection.add_reminder(title, description=description)
+        index.invalidate(list_id)
+        reminder_cache.invalidate_list(user_id, list_id)
 
         return jsonify({
             "success": True,
@@ -305,8 +756,12 @@ def create_reminder():
                 "description": reminder.get('description', '')
             }
         }), 201
+    except PoolExhausted:
+        raise
     except Exception as e:
         logger.error(f"Error creating reminder: {str(e)}")
+        if is_session_error(e):
+            session_pool.invalidate(g.user_id)
         return jsonify({"error": str(e)}), 500
 
 
@@ -323,26 +778,117 @@ def complete_reminder(reminder_id):
         if not list_id:
             return jsonify({"error": "list_id is required"}), 400
 
-        # Find the collection
-        collection = None
-        for col in service.reminders.collections:
-            if col.guid == list_id:
-                collection = col
-                break
-
+        index = reminder_indexes.get(user_id, service)
+        collection = index.collection(list_id)
         if not collection:
             return jsonify({"error": "List not found"}), 404
 
         # Find and complete the reminder
-        for reminder in collection:
-            if reminder.get('guid') == reminder_id:
-                reminder['completed'] = True
-                collection.save()
-                return jsonify({"success": True})
-
-        return jsonify({"error": "Reminder not found"}), 404
+        reminder = index.reminder(collection, reminder_id)
+        if reminder is None:
+            return jsonify({"error": "Reminder not found"}), 404
+
+        reminder['completed'] = True
+        collection.save()
+        reminder_cache.invalidate_list(user_id, list_id)
+        return jsonify({"success": True})
+    except PoolExhausted:
+        raise
     except Exception as e:
         logger.error(f"Error completing reminder: {str(e)}")
+        if is_session_error(e):
+            session_pool.invalidate(g.user_id)
+        return jsonify({"error": str(e)}), 500
+
+
+MAX_BATCH_COMPLETIONS = 100
+
+
+@app.route('/api/reminders/complete-batch', methods=['POST'])
+@require_auth
+def complete_reminders_batch():
+    """
+    Mark many reminders as completed for authenticated user.
+    Items are grouped by list so each collection is saved once, and every
+    item gets its own result.
+    """
+    try:
+        data = request.json or {}
+        items = data.get('items')
+
+        if not isinstance(items, list) or not items:
+            return jsonify({"error": "items must be a non-empty list"}), 400
+        if len(items) > MAX_BATCH_COMPLETIONS:
+            return jsonify({"error": f"At most {MAX_BATCH_COMPLETIONS} items per batch"}), 400
+
+        results = []
+        by_list = {}
+        # A repeated item is applied once and reported like the first one,
+        # so it cannot read as completed after that one was rolled back
+        firsts = {}
+        duplicates = []
+        for item in items:
+            list_id = item.get('list_id') if isinstance(item, dict) else None
+            reminder_id = item.get('reminder_id') if isinstance(item, dict) else None
+            result = {"list_id": list_id, "reminder_id": reminder_id}
+            results.append(result)
+            if not list_id or not reminder_id:
+                result.update(status="invalid", error="list_id and reminder_id are required")
+            elif (list_id, reminder_id) in firsts:
+                duplicates.append((result, firsts[(list_id, reminder_id)]))
+            else:
+                firsts[(list_id, reminder_id)] = result
+                by_list.setdefault(list_id, []).append(result)
+
+        user_id = g.user_id
+        service = get_icloud_service_for_user(user_id)
+        index = reminder_indexes.get(user_id, service)
+
+        for list_id, list_results in by_list.items():
+            collection = index.collection(list_id)
+            if not collection:
+                for result in list_results:
+                    result.update(status="not_found", error="List not found")
+                continue
+
+            changed = []
+            for result in list_results:
+                reminder = index.reminder(collection, result['reminder_id'])
+                if reminder is None:
+                    result.update(status="not_found", error="Reminder not found")
+                    continue
+                if not reminder.get('completed'):
+                    reminder['completed'] = True
+                    changed.append((reminder, result))
+                result['status'] = "completed"
+
+            if not changed:
+                continue
+            try:
+                collection.save()
+            except Exception as e:
+                # The whole collection failed; undo so the index matches iCloud
+                logger.error(f"Error saving completions: {str(e)}")
+                for reminder, result in changed:
+                    reminder['completed'] = False
+                    result.update(status="error", error=str(e))
+                if is_session_error(e):
+                    session_pool.invalidate(user_id)
+            reminder_cache.invalidate_list(user_id, list_id)
+
+        for result, first in duplicates:
+            result['status'] = first['status']
+            if 'error' in first:
+                result['error'] = first['error']
+
+        completed = sum(1 for result in results if result.get('status') == "completed")
+        return jsonify({"success": completed == len(results), "completed": completed, "results": results})
+    except PoolExhausted:
+        raise
+    except Exception as e:
+        logger.error(f"Error completing reminders: {str(e)}")
+        if is_session_error(e):
+            session_pool.invalidate(g.user_id)
         return jsonify({"error": str(e)}), 500
 
 
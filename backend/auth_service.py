@@ -6,6 +6,8 @@ Handles user registration, login, and credential encryption
 
 import sqlite3
 import os
+import hmac
+import time
 import jwt
 from datetime import datetime, timedelta
 from cryptography.fernet import Fernet
@@ -13,6 +15,10 @@ from flask import Flask, jsonify, request, g, current_app
 from functools import wraps
 import logging
 
+from db_config import connect_sqlite, execute_prepared, get_connection_pool
+from credential_cache import CredentialCache
+from token_cache import VerifiedTokenCache, token_hash
+
 # Configure logging
 logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger(__name__)
@@ -46,25 +52,61 @@ else:
 
 fernet = Fernet(ENCRYPTION_KEY)
 
+# Decrypted credentials of recently active users. Each gunicorn worker has
+# its own cache, so the TTL bounds how long another worker can keep using
+# a password after it changes.
+credential_cache = CredentialCache(
+    ttl=int(os.environ.get('CREDENTIAL_CACHE_TTL', 300)),
+    max_size=int(os.environ.get('CREDENTIAL_CACHE_SIZE', 1000))
+)
+
+# Tokens whose signature was checked recently. A cached token is only
+# re-verified (and re-checked against revoked_tokens) after
+# VERIFIED_TOKEN_MAX_AGE seconds.
+token_cache = VerifiedTokenCache(
+    max_size=int(os.environ.get('VERIFIED_TOKEN_CACHE_SIZE', 10000)),
+    max_age=int(os.environ.get('VERIFIED_TOKEN_MAX_AGE', 60))
+)
+
 
 def get_db():
-    """Get database connection"""
+    """Get database connection, checked out of the process-wide pool"""
     if 'db' not in g:
         # Use current_app to get the app in the current context
         database_path = current_app.config['DATABASE']
-        g.db = sqlite3.connect(
-            database_path,
-            detect_types=sqlite3.PARSE_DECLTYPES
-        )
-        g.db.row_factory = sqlite3.Row
+        if database_path == ':memory:':
+            # Each in-memory connection is its own database, so never pool it
+            g.db_pool = None
+            g.db = connect_sqlite(database_path)
+        else:
+            g.db_pool = get_connection_pool(database_path)
+            g.db = g.db_pool.acquire()
     return g.db
 
 
+def release_db():
+    """
+    Hand the request's pooled connection back early, before slow iCloud
+    calls; get_db() checks out another if the request needs one again.
+    In-memory databases stay open, since closing one loses its data.
+    """
+    pool = g.get('db_pool')
+    if pool is None:
+        return
+    g.pop('db_pool')
+    pool.release(g.pop('db'))
+
+
 @app.teardown_appcontext
 def close_db(error):
-    """Close database connection"""
+    """Return database connection to the pool"""
     db = g.pop('db', None)
-    if db is not None:
+    pool = g.pop('db_pool', None)
+    if db is None:
+        return
+    if pool is not None:
+        pool.release(db)
+    else:
         db.close()
 
 
@@ -80,6 +122,12 @@ def init_db():
             created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
         )
     ''')
+    db.execute('''
+        CREATE TABLE IF NOT EXISTS revoked_tokens (
+            token_hash TEXT PRIMARY KEY,
+            expires_at INTEGER NOT NULL
+        )
+    ''')
     db.commit()
 
 
@@ -103,11 +151,10 @@ def generate_token(user_id):
     return token
 
 
-def verify_token(token):
-    """Verify JWT token and return user_id"""
+def decode_token(token):
+    """Verify JWT signature and expiry; return the payload or None"""
     try:
-        payload = jwt.decode(token, current_app.config['SECRET_KEY'], algorithms=['HS256'])
-        return payload['user_id']
+        return jwt.decode(token, current_app.config['SECRET_KEY'], algorithms=['HS256'])
     except jwt.ExpiredSignatureError:
         logger.warning("Token expired")
         return None
@@ -116,6 +163,58 @@ def verify_token(token):
         return None
 
 
+def verify_token(token):
+    """Verify JWT token and return user_id"""
+    payload = decode_token(token)
+    if payload is None:
+        return None
+    return payload['user_id']
+
+
+def is_token_revoked(token):
+    db = get_db()
+    row = db.execute(
+        'SELECT 1 FROM revoked_tokens WHERE token_hash = ?',
+        (token_hash(token),)
+    ).fetchone()
+    return row is not None
+
+
+def authenticate_token(token):
+    """
+    Return the user_id of a valid, unrevoked token, or None. Tokens seen
+    recently are served from the verified-token cache without checking
+    the signature again.
+    """
+    user_id = token_cache.get(token)
+    if user_id is not None:
+        return user_id
+
+    payload = decode_token(token)
+    if payload is None or is_token_revoked(token):
+        return None
+
+    token_cache.put(token, payload['user_id'], payload['exp'])
+    return payload['user_id']
+
+
+def revoke_token(token):
+    """Reject token from now on (until it would have expired anyway)"""
+    payload = decode_token(token)
+    if payload is None:
+        return
+
+    db = get_db()
+    # Revocations are only needed until the token expires on its own
+    db.execute('DELETE FROM revoked_tokens WHERE expires_at < ?', (int(time.time()),))
+    db.execute(
+        'INSERT OR IGNORE INTO revoked_tokens (token_hash, expires_at) VALUES (?, ?)',
+        (token_hash(token), payload['exp'])
+    )
+    db.commit()
+    token_cache.revoke(token, payload['exp'])
+
+
 def require_auth(f):
     """Decorator to require authentication for endpoints"""
     @wraps(f)
@@ -125,20 +224,27 @@ def require_auth(f):
         if not auth_header:
             return jsonify({"error": "Authorization header missing"}), 401
 
+        # Expected format: "Bearer <token>"
+        scheme, _, token = auth_header.partition(' ')
+        if scheme.lower() != 'bearer' or not token:
+            return jsonify({"error": "Invalid authorization header format"}), 401
+
         try:
-            # Expected format: "Bearer <token>"
-            token = auth_header.split(' ')[1]
-            user_id = verify_token(token)
+            user_id = authenticate_token(token)
+        except KeyError:
+            return jsonify({"error": "Invalid authorization header format"}), 401
 
-            if user_id is None:
-                return jsonify({"error": "Invalid or expired token"}), 401
+        # The endpoint may spend seconds on iCloud; do not hold a
+        # connection other requests are waiting for
+        release_db()
 
-            # Store user_id in request context
-            g.user_id = user_id
-            return f(*args, **kwargs)
+        if user_id is None:
+            return jsonify({"error": "Invalid or expired token"}), 401
 
-        except (IndexError, KeyError):
-            return jsonify({"error": "Invalid authorization header format"}), 401
+        # Store user_id and token in request context
+        g.user_id = user_id
+        g.token = token
+        return f(*args, **kwargs)
 
     return decorated_function
 
@@ -166,6 +272,8 @@ def create_user(username, apple_id, apple_password):
             (username, apple_id, encrypted_password)
         )
         db.commit()
+        # The id may belong to a deleted user still in the cache
+        credential_cache.invalidate(cursor.lastrowid)
         return cursor.lastrowid, None
     except sqlite3.IntegrityError as e:
         logger.error(f"Database error creating user: {e}")
@@ -180,6 +288,7 @@ def authenticate_user(username, apple_id, apple_password):
         'SELECT id, username, apple_id, apple_password_encrypted FROM users WHERE username = ?',
         (username,)
     ).fetchone()
+    release_db()
 
     if not user:
         return None
@@ -188,13 +297,25 @@ def authenticate_user(username, apple_id, apple_password):
     stored_apple_id = user['apple_id']
     stored_encrypted_password = user['apple_password_encrypted']
 
-    try:
-        decrypted_password = decrypt_password(stored_encrypted_password)
-    except Exception as e:
-        logger.error(f"Failed to decrypt password: {e}")
-        return None
-
-    if apple_id == stored_apple_id and apple_password == decrypted_password:
+    # Fernet output is randomized, so a matching ciphertext means the
+    # cached plaintext is for the password currently stored
+    cached = credential_cache.get(user['id'])
+    if cached is not None and cached['apple_password_encrypted'] == stored_encrypted_password:
+        decrypted_password = cached['apple_password']
+    else:
+        try:
+            decrypted_password = decrypt_password(stored_encrypted_password)
+        except Exception as e:
+            logger.error(f"Failed to decrypt password: {e}")
+            return None
+        credential_cache.put(user['id'], {
+            'apple_id': stored_apple_id,
+            'apple_password': decrypted_password,
+            'apple_password_encrypted': stored_encrypted_password
+        })
+
+    if (hmac.compare_digest(apple_id.encode(), stored_apple_id.encode())
+            and hmac.compare_digest(apple_password.encode(), decrypted_password.encode())):
         return {
             'id': user['id'],
             'username': user['username'],
@@ -205,27 +326,54 @@ def authenticate_user(username, apple_id, apple_password):
 
 
 def get_user_credentials(user_id):
-    """Get decrypted credentials for a user"""
+    """Get decrypted credentials for a user, from the credential cache when possible"""
+    cached = credential_cache.get(user_id)
+    if cached is not None:
+        return {
+            'apple_id': cached['apple_id'],
+            'apple_password': cached['apple_password']
+        }
+
+    # An update that commits while this read is in flight keeps it out of the cache
+    generation = credential_cache.generation()
     db = get_db()
 
-    user = db.execute(
-        'SELECT apple_id, apple_password_encrypted FROM users WHERE id = ?',
-        (user_id,)
-    ).fetchone()
+    user = execute_prepared(db, 'user_credentials', (user_id,)).fetchone()
+    # Callers go on to log in to iCloud
+    release_db()
 
     if not user:
         return None
 
     try:
         decrypted_password = decrypt_password(user['apple_password_encrypted'])
-        return {
-            'apple_id': user['apple_id'],
-            'apple_password': decrypted_password
-        }
     except Exception as e:
         logger.error(f"Failed to decrypt credentials: {e}")
         return None
 
+    credential_cache.put(user_id, {
+        'apple_id': user['apple_id'],
+        'apple_password': decrypted_password,
+        'apple_password_encrypted': user['apple_password_encrypted']
+    }, generation)
+    return {
+        'apple_id': user['apple_id'],
+        'apple_password': decrypted_password
+    }
+
+
+def update_apple_credentials(user_id, apple_id, apple_password):
+    """Store new Apple credentials for a user; returns False if the user does not exist"""
+    db = get_db()
+
+    cursor = db.execute(
+        'UPDATE users SET apple_id = ?, apple_password_encrypted = ? WHERE id = ?',
+        (apple_id, encrypt_password(apple_password), user_id)
+    )
+    db.commit()
+    credential_cache.invalidate(user_id)
+    return cursor.rowcount > 0
+
 
 @app.route('/api/auth/register', methods=['POST'])
 def register():
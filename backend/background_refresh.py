@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+Background refresh of cached iCloud data
+Runs cache refreshes on a small thread pool so requests can answer from
+the last known snapshot instead of waiting on iCloud
+"""
+
+import logging
+import threading
+from concurrent.futures import ThreadPoolExecutor
+
+logger = logging.getLogger(__name__)
+
+
+class BackgroundRefresher:
+    """
+    Thread pool that runs at most one refresh per key at a time.
+
+    Keys identify what is being refreshed, e.g. (user_id, 'reminders',
+    list_id). Scheduling a key that is already queued or running is a
+    no-op, so a burst of stale reads costs one iCloud fetch.
+    """
+
+    def __init__(self, max_workers=4):
+        self.max_workers = max_workers
+        self._executor = ThreadPoolExecutor(
+            max_workers=max_workers,
+            thread_name_prefix='icloud-refresh'
+        )
+        self._pending = set()
+        self._lock = threading.Lock()
+        self._idle = threading.Condition(self._lock)
+        self._stats = {
+            'scheduled': 0,
+            'coalesced': 0,
+            'completed': 0,
+            'failed': 0,
+        }
+
+    def schedule(self, key, fn, *args):
+        """Run fn(*args) in the background unless key is already pending"""
+        with self._lock:
+            if key in self._pending:
+                self._stats['coalesced'] += 1
+                return False
+            self._pending.add(key)
+            self._stats['scheduled'] += 1
+
+        try:
+            self._executor.submit(self._run, key, fn, args)
+        except RuntimeError:
+            # Executor shut down (interpreter exit)
+            self._finish(key, 'failed')
+            return False
+        return True
+
+    def is_pending(self, key):
+        with self._lock:
+            return key in self._pending
+
+    def wait_idle(self, timeout=None):
+        """Block until nothing is pending; returns False on timeout"""
+        with self._idle:
+            return self._idle.wait_for(lambda: not self._pending, timeout)
+
+    def stats(self):
+        with self._lock:
+            stats = dict(self._stats)
+            stats['pending'] = len(self._pending)
+            stats['max_workers'] = self.max_workers
+            return stats
+
+    def shutdown(self, wait=True):
+        self._executor.shutdown(wait=wait)
+
+    def _run(self, key, fn, args):
+        outcome = 'completed'
+        try:
+            fn(*args)
+        except Exception as e:
+            outcome = 'failed'
+            logger.warning(f"Background refresh failed: {str(e)}")
+        finally:
+            self._finish(key, outcome)
+
+    def _finish(self, key, outcome):
+        with self._idle:
+            self._pending.discard(key)
+            self._stats[outcome] += 1
+            self._idle.notify_all()
@@ -0,0 +1,373 @@
+#!/usr/bin/env python3
+"""
+Load and latency benchmark for the Flask backend
+Drives the /api/auth/* and /api/reminders/* endpoints in-process against a
+fake PyiCloudService with configurable latency and list sizes, reports
+throughput and p50/p95/p99 latency per endpoint, and fails when results
+regress past a stored baseline.
+
+    python benchmark.py                                 # report only
+    python benchmark.py --save-baseline benchmark_baseline.json
+    python benchmark.py --baseline benchmark_baseline.json
+"""
+
+import argparse
+import itertools
+import json
+import os
+import sys
+import tempfile
+import threading
+import time
+from concurrent.futures import ThreadPoolExecutor
+from unittest.mock import patch
+
+# Regressions are only meaningful against a baseline taken with the same
+# settings, so these are stored with the results and compared first
+CONFIG_KEYS = ('requests', 'concurrency', 'users', 'lists', 'reminders', 'latency_ms', 'login_latency_ms')
+
+
+def parse_args(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[1])
+    parser.add_argument('--requests', type=int, default=200, help='requests per endpoint')
+    parser.add_argument('--concurrency', type=int, default=8, help='concurrent clients')
+    parser.add_argument('--users', type=int, default=4, help='registered users the clients rotate through')
+    parser.add_argument('--lists', type=int, default=5, help='reminder lists per user')
+    parser.add_argument('--reminders', type=int, default=200, help='reminders per list')
+    parser.add_argument('--latency-ms', type=float, default=20, help='simulated iCloud round trip')
+    parser.add_argument('--login-latency-ms', type=float, default=200, help='simulated iCloud login')
+    parser.add_argument('--endpoints', help='comma-separated subset of endpoints to run')
+    parser.add_argument('--baseline', help='fail if results regress past this baseline file')
+    parser.add_argument('--save-baseline', metavar='PATH', help='write results as the new baseline')
+    parser.add_argument('--tolerance', type=float, default=0.25,
+                        help='allowed regression as a fraction of the baseline (default 0.25)')
+    return parser.parse_args(argv)
+
+
+class FakeCollection:
+    """Stand-in for a pyicloud reminders collection"""
+
+    def __init__(self, guid, title, reminder_count, latency):
+        self.guid = guid
+        self.title = title
+        self.color = 'blue'
+        self.ctag = 1
+        self._latency = latency
+        self._lock = threading.Lock()
+        self._reminders = [
+            {
+                'guid': f'{guid}-reminder-{i}',
+                'title': f'Reminder {i}',
+                'description': '',
+                'completed': False,
+                'dueDate': None,
+                'priority': 0
+            }
+            for i in range(reminder_count)
+        ]
+
+    def __iter__(self):
+        time.sleep(self._latency)
+        with self._lock:
+            return iter(list(self._reminders))
+
+    def add_reminder(self, title, description=''):
+        time.sleep(self._latency)
+        with self._lock:
+            reminder = {
+                'guid': f'{self.guid}-reminder-{len(self._reminders)}',
+                'title': title,
+                'description': description,
+                'completed': False
+            }
+            self._reminders.append(reminder)
+            self.ctag += 1
+            return reminder
+
+    def save(self):
+        time.sleep(self._latency)
+        with self._lock:
+            self.ctag += 1
+
+
+class FakeReminders:
+    def __init__(self, collections, latency):
+        self._collections = collections
+        self._latency = latency
+
+    @property
+    def collections(self):
+        time.sleep(self._latency)
+        return self._collections
+
+
+def fake_icloud_factory(args):
+    """PyiCloudService replacement; each Apple ID keeps its data across logins"""
+    latency = args.latency_ms / 1000
+    accounts = {}
+    accounts_lock = threading.Lock()
+
+    def create(apple_id, apple_password, cookie_directory=None):
+        time.sleep(args.login_latency_ms / 1000)
+        with accounts_lock:
+            if apple_id not in accounts:
+                accounts[apple_id] = [
+                    FakeCollection(f'{apple_id}-list-{i}', f'List {i}', args.reminders, latency)
+                    for i in range(args.lists)
+                ]
+            collections = accounts[apple_id]
+
+        service = type('FakeICloudService', (), {})()
+        service.requires_2fa = False
+        service.reminders = FakeReminders(collections, latency)
+        return service
+
+    return create
+
+
+class Context:
+    """Per-run state shared by the endpoint drivers"""
+
+    def __init__(self, args):
+        self.args = args
+        self.users = []
+        self.counter = itertools.count()
+        self.counter_lock = threading.Lock()
+
+    def next(self):
+        with self.counter_lock:
+            return next(self.counter)
+
+    def user(self):
+        return self.users[self.next() % len(self.users)]
+
+
+def auth_header(user):
+    return {'Authorization': f"Bearer {user['token']}"}
+
+
+def drive_register(client, ctx):
+    n = ctx.next()
+    return client.post('/api/auth/register', json={
+        'username': f'bench-new-{n}',
+        'apple_id': f'bench-new-{n}@icloud.com',
+        'apple_password': 'benchmark_password'
+    }), (201,)
+
+
+def drive_login(client, ctx):
+    user = ctx.user()
+    return client.post('/api/auth/login', json={
+        'username': user['username'],
+        'apple_id': user['apple_id'],
+        'apple_password': 'benchmark_password'
+    }), (200,)
+
+
+def drive_lists(client, ctx):
+    return client.get('/api/reminders/lists', headers=auth_header(ctx.user())), (200,)
+
+
+def drive_list(client, ctx):
+    user = ctx.user()
+    list_id = f"{user['apple_id']}-list-{ctx.next() % ctx.args.lists}"
+    return client.get(f'/api/reminders/list/{list_id}?limit=50&fields=id,title,completed',
+                      headers=auth_header(user)), (200,)
+
+
+def drive_changes(client, ctx):
+    user = ctx.user()
+    list_id = f"{user['apple_id']}-list-{ctx.next() % ctx.args.lists}"
+    return client.get(f'/api/reminders/changes?list_id={list_id}&fields=id,title,completed',
+                      headers=auth_header(user)), (200,)
+
+
+def drive_create(client, ctx):
+    user = ctx.user()
+    return client.post('/api/reminders', json={
+        'list_id': f"{user['apple_id']}-list-0",
+        'title': f'Benchmark {ctx.next()}'
+    }, headers=auth_header(user)), (201,)
+
+
+def drive_complete(client, ctx):
+    user = ctx.user()
+    n = ctx.next()
+    list_id = f"{user['apple_id']}-list-{n % ctx.args.lists}"
+    reminder_id = f'{list_id}-reminder-{n % ctx.args.reminders}'
+    return client.post(f'/api/reminders/{reminder_id}/complete', json={'list_id': list_id},
+                       headers=auth_header(user)), (200,)
+
+
+def drive_complete_batch(client, ctx):
+    user = ctx.user()
+    n = ctx.next()
+    list_id = f"{user['apple_id']}-list-{n % ctx.args.lists}"
+    items = [
+        {'list_id': list_id, 'reminder_id': f'{list_id}-reminder-{(n * 10 + i) % ctx.args.reminders}'}
+        for i in range(10)
+    ]
+    return client.post('/api/reminders/complete-batch', json={'items': items},
+                       headers=auth_header(user)), (200,)
+
+
+ENDPOINTS = {
+    'auth_register': drive_register,
+    'auth_login': drive_login,
+    'reminders_lists': drive_lists,
+    'reminders_list': drive_list,
+    'reminders_changes': drive_changes,
+    'reminders_create': drive_create,
+    'reminders_complete': drive_complete,
+    'reminders_complete_batch': drive_complete_batch,
+}
+
+
+def percentile(sorted_values, pct):
+    """Nearest-rank percentile of an ascending list"""
+    if not sorted_values:
+        return 0.0
+    rank = max(1, int(round(pct / 100 * len(sorted_values))))
+    return sorted_values[min(rank, len(sorted_values)) - 1]
+
+
+def run_endpoint(app, driver, ctx):
+    args = ctx.args
+    latencies = []
+    errors = []
+    lock = threading.Lock()
+    clients = threading.local()
+
+    def one(_):
+        if not hasattr(clients, 'client'):
+            clients.client = app.test_client()
+        start = time.perf_counter()
+        response, expected = driver(clients.client, ctx)
+        elapsed = time.perf_counter() - start
+        with lock:
+            latencies.append(elapsed * 1000)
+            if response.status_code not in expected:
+                errors.append(response.status_code)
+
+    started = time.perf_counter()
+    with ThreadPoolExecutor(max_workers=args.concurrency) as pool:
+        list(pool.map(one, range(args.requests)))
+    wall = time.perf_counter() - started
+
+    latencies.sort()
+    return {
+        'requests': len(latencies),
+        'errors': len(errors),
+        'throughput_rps': round(len(latencies) / wall, 1),
+        'p50_ms': round(percentile(latencies, 50), 2),
+        'p95_ms': round(percentile(latencies, 95), 2),
+        'p99_ms': round(percentile(latencies, 99), 2),
+    }
+
+
+def run(args):
+    workdir = tempfile.mkdtemp(prefix='pebble-bench-')
+    os.environ['DATABASE_PATH'] = os.path.join(workdir, 'users.db')
+    os.environ['ICLOUD_SESSION_DIR'] = os.path.join(workdir, 'sessions')
+    os.environ.setdefault('ICLOUD_SESSION_POOL_SIZE', str(max(100, args.users)))
+
+    # Imported late so the environment above is in place for module setup
+    import app as app_module
+
+    app = app_module.app
+    # The benchmark client would trip the per-IP limits within seconds
+    app.config['RATELIMIT_ENABLED'] = False
+    app_module.limiter.enabled = False
+
+    selected = args.endpoints.split(',') if args.endpoints else list(ENDPOINTS)
+    unknown = [name for name in selected if name not in ENDPOINTS]
+    if unknown:
+        raise SystemExit(f"Unknown endpoints: {', '.join(unknown)}")
+
+    ctx = Context(args)
+    results = {}
+    with patch.object(app_module, 'PyiCloudService', fake_icloud_factory(args)):
+        client = app.test_client()
+        for i in range(args.users):
+            user = {'username': f'bench-{i}', 'apple_id': f'bench-{i}@icloud.com'}
+            response = client.post('/api/auth/register', json=dict(user, apple_password='benchmark_password'))
+            user['token'] = response.get_json()['token']
+            ctx.users.append(user)
+
+        for name in selected:
+            results[name] = run_endpoint(app, ENDPOINTS[name], ctx)
+            print_row(name, results[name])
+
+    app_module.background_refresher.shutdown(wait=True)
+    return {
+        'config': {key: getattr(args, key) for key in CONFIG_KEYS},
+        'endpoints': results,
+    }
+
+
+def print_header():
+    print(f"{'endpoint':<26} {'reqs':>6} {'errors':>6} {'req/s':>9} {'p50 ms':>9} {'p95 ms':>9} {'p99 ms':>9}")
+
+
+def print_row(name, result):
+    print(f"{name:<26} {result['requests']:>6} {result['errors']:>6} {result['throughput_rps']:>9} "
+          f"{result['p50_ms']:>9} {result['p95_ms']:>9} {result['p99_ms']:>9}")
+
+
+def compare(results, baseline, tolerance):
+    """Return a list of regressions; empty when results are within tolerance"""
+    if baseline.get('config') != results['config']:
+        return [f"baseline settings {baseline.get('config')} differ from this run {results['config']}"]
+
+    regressions = []
+    for name, current in results['endpoints'].items():
+        previous = baseline['endpoints'].get(name)
+        if previous is None:
+            continue
+        for key in ('p50_ms', 'p95_ms', 'p99_ms'):
+            if current[key] > previous[key] * (1 + tolerance):
+                regressions.append(f"{name}: {key} {current[key]} > baseline {previous[key]}")
+        if current['throughput_rps'] < previous['throughput_rps'] * (1 - tolerance):
+            regressions.append(f"{name}: throughput {current['throughput_rps']} req/s < "
+                               f"baseline {previous['throughput_rps']} req/s")
+    return regressions
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    # Baselines are per machine, so none is committed; without one the
+    # gate would pass whatever the results
+    if args.baseline and not args.save_baseline and not os.path.exists(args.baseline):
+        print(f"FAIL: no baseline at {args.baseline}, so there is nothing to gate against; "
+              "run `make benchmark-baseline` to record one")
+        return 2
+
+    print_header()
+    results = run(args)
+
+    if args.save_baseline:
+        with open(args.save_baseline, 'w') as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write('\n')
+        print(f"\nBaseline written to {args.save_baseline}")
+
+    failed = [name for name, result in results['endpoints'].items() if result['errors']]
+    if failed:
+        print(f"\nFAIL: requests failed for {', '.join(failed)}")
+        return 1
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = compare(results, json.load(f), args.tolerance)
+        if regressions:
+            print(f"\nFAIL: regressed past baseline (tolerance {args.tolerance:.0%}):")
+            for regression in regressions:
+                print(f"  {regression}")
+            return 1
+        print(f"\nOK: within {args.tolerance:.0%} of baseline")
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
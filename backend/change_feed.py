@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""
+Per-user change feed for reminders
+Diffs each observed list against the previous snapshot and keeps a
+bounded log of changes so clients can sync with an opaque token. Tokens
+name a version of the list's content, so every worker process derives the
+same token for the same list.
+"""
+
+import base64
+import hashlib
+import json
+import threading
+import zlib
+from collections import OrderedDict, deque
+
+CHANGE_ADDED = 'added'
+CHANGE_MODIFIED = 'modified'
+CHANGE_COMPLETED = 'completed'
+CHANGE_DELETED = 'deleted'
+
+
+def _list_tag(list_id):
+    return format(zlib.crc32(list_id.encode()) & 0xffffffff, '08x')
+
+
+def content_version(reminders):
+    """Hash of a list's reminders, in order; equal content gives an equal version"""
+    canonical = json.dumps(reminders, sort_keys=True, separators=(',', ':'), default=str)
+    return hashlib.sha256(canonical.encode()).hexdigest()[:16]
+
+
+def _encode(raw):
+    return base64.urlsafe_b64encode(raw.encode()).decode().rstrip('=')
+
+
+def _decode(value):
+    """Split an encoded token into its fields; raises ValueError if malformed"""
+    padded = value + '=' * (-len(value) % 4)
+    return base64.urlsafe_b64decode(padded.encode()).decode().split(':')
+
+
+def encode_cursor(offset, sync_token):
+    return _encode(f"{offset}:{sync_token}")
+
+
+def decode_cursor(cursor, sync_token):
+    """
+    Return the offset a cursor points at, or None if the list has changed
+    since the cursor was minted. Cursors are tied to the sync token of the
+    list they came from, so pages never mix two versions, and since that
+    token is derived from the list's content any worker can continue them.
+    Raises ValueError for a malformed cursor.
+    """
+    offset, token = _decode(cursor)
+    offset = int(offset)
+    if offset < 0 or token != sync_token:
+        return None
+    return offset
+
+
+class _ListFeed:
+    def __init__(self):
+        self.seq = 0
+        self.log = deque()
+        # version -> seq of the last change before it was observed
+        self.versions = OrderedDict()
+        self.version = None
+        self.snapshot = None
+        self.source = None
+
+
+class ChangeFeed:
+    """
+    Thread-safe change log keyed by user_id and list.
+
+    A token names one list and a content version of it. Every process
+    that has observed a list's current content issues and accepts the same
+    token for it, so an up-to-date client gets an empty change set from any
+    worker. Changes since an older version are answered by a process that
+    observed that version, while it is still within the retained log; any
+    other token is rejected and the caller falls back to a full snapshot.
+    """
+
+    def __init__(self, max_log_entries=1000, max_users=1000):
+        self.max_log_entries = max_log_entries
+        self.max_users = max_users
+        self._users = OrderedDict()
+        self._lock = threading.Lock()
+
+    def observe(self, user_id, list_id, reminders):
+        """Record the current reminders of a list and return its sync token"""
+        with self._lock:
+            feed = self._list_locked(user_id, list_id)
+
+            # The cache hands back the same list object while nothing changed
+            if feed.source is reminders:
+                return self._token(list_id, feed.version)
+
+            version = content_version(reminders)
+            current = OrderedDict((r['id'], r) for r in reminders)
+            if feed.snapshot is not None and version != feed.version:
+                for change in self._diff(feed.snapshot, current):
+                    feed.seq += 1
+                    feed.log.append((feed.seq, change))
+                while len(feed.log) > self.max_log_entries:
+                    feed.log.popleft()
+
+            feed.snapshot = current
+            feed.source = reminders
+            feed.version = version
+            feed.versions.pop(version, None)
+            feed.versions[version] = feed.seq
+            oldest = feed.log[0][0] if feed.log else feed.seq + 1
+            while next(iter(feed.versions.values())) < oldest - 1:
+                feed.versions.popitem(last=False)
+            return self._token(list_id, version)
+
+    def changes_since(self, user_id, list_id, token):
+        """
+        Return the collapsed changes for a list since token, or None if the
+        token cannot be honoured and the client must resync from scratch.
+        """
+        version = self._parse_token(token, list_id)
+        if version is None:
+            return None
+
+        with self._lock:
+            lists = self._users.get(user_id)
+            feed = lists.get(list_id) if lists else None
+            if feed is None or version not in feed.versions:
+                return None
+            since = feed.versions[version]
+
+            collapsed = OrderedDict()
+            for seq, change in feed.log:
+                if seq <= since:
+                    continue
+                key = change.get('id') or change['reminder']['id']
+                collapsed[key] = self._merge(collapsed.get(key), change)
+
+            return [change for change in collapsed.values() if change is not None]
+
+    def forget(self, user_id):
+        with self._lock:
+            self._users.pop(user_id, None)
+
+    def clear(self):
+        with self._lock:
+            self._users.clear()
+
+    @staticmethod
+    def _diff(previous, current):
+        for reminder_id, reminder in current.items():
+            old = previous.get(reminder_id)
+            if old is None:
+                yield {'type': CHANGE_ADDED, 'reminder': reminder}
+            elif old != reminder:
+                completed_only = (
+                    reminder.get('completed') and not old.get('completed') and
+                    dict(old, completed=True) == reminder
+                )
+                change_type = CHANGE_COMPLETED if completed_only else CHANGE_MODIFIED
+                yield {'type': change_type, 'reminder': reminder}
+        for reminder_id in previous:
+            if reminder_id not in current:
+                yield {'type': CHANGE_DELETED, 'id': reminder_id}
+
+    @staticmethod
+    def _merge(earlier, later):
+        """Collapse two changes to the same reminder into one"""
+        if earlier is None:
+            return later
+        if earlier['type'] == CHANGE_ADDED:
+            if later['type'] == CHANGE_DELETED:
+                return None
+            return {'type': CHANGE_ADDED, 'reminder': later['reminder']}
+        if later['type'] == CHANGE_COMPLETED and earlier['type'] == CHANGE_MODIFIED:
+            return {'type': CHANGE_MODIFIED, 'reminder': later['reminder']}
+        return later
+
+    @staticmethod
+    def _token(list_id, version):
+        return _encode(f"{_list_tag(list_id)}:{version}")
+
+    @staticmethod
+    def _parse_token(token, list_id):
+        if not token:
+            return None
+        try:
+            tag, version = _decode(token)
+        except ValueError:
+            return None
+        if tag != _list_tag(list_id) or not version:
+            return None
+        return version
+
+    def _list_locked(self, user_id, list_id):
+        lists = self._users.get(user_id)
+        if lists is None:
+            lists = {}
+            self._users[user_id] = lists
+            while len(self._users) > self.max_users:
+                self._users.popitem(last=False)
+        self._users.move_to_end(user_id)
+        feed = lists.get(list_id)
+        if feed is None:
+            feed = lists[list_id] = _ListFeed()
+        return feed
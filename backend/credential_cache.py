@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+"""
+Decrypted credential cache
+Keeps recently used Apple credentials in process memory for a short TTL
+so authenticated requests skip the users query and the Fernet decrypt
+"""
+
+import threading
+import time
+from collections import OrderedDict
+
+
+class CredentialCache:
+    """
+    Thread-safe LRU of user_id -> {'apple_id', 'apple_password',
+    'apple_password_encrypted'}. The ciphertext lets a caller that has
+    just read the users row check that the entry is still current.
+
+    Entries expire ttl seconds after they were stored, whether or not they
+    are used, so a cached password is never served past the TTL.
+    Callers must invalidate a user whenever their stored credentials
+    change. A caller that reads credentials from the database takes a
+    generation() first and passes it to put(), which then skips the entry
+    if the user was invalidated while the read was in flight. A ttl of 0
+    disables the cache.
+    """
+
+    def __init__(self, ttl=300, max_size=1000):
+        self.ttl = ttl
+        self.max_size = max_size
+        self._entries = OrderedDict()
+        # Bumped by every invalidation; user_id -> generation it was last
+        # invalidated at, for the most recent max_size users
+        self._generation = 0
+        self._invalidated = OrderedDict()
+        # A put() from before this generation may have missed a forgotten
+        # invalidation
+        self._forgotten = 0
+        self._lock = threading.Lock()
+        self._stats = {
+            'hits': 0,
+            'misses': 0,
+            'expirations': 0,
+            'invalidations': 0,
+        }
+
+    def get(self, user_id):
+        """Return a copy of the cached credentials, or None"""
+        with self._lock:
+            entry = self._entries.get(user_id)
+            if entry is not None and time.monotonic() - entry[0] >= self.ttl:
+                del self._entries[user_id]
+                self._stats['expirations'] += 1
+                entry = None
+            if entry is None:
+                self._stats['misses'] += 1
+                return None
+            self._entries.move_to_end(user_id)
+            self._stats['hits'] += 1
+            return dict(entry[1])
+
+    def generation(self):
+        """Take before reading credentials that will be passed to put()"""
+        with self._lock:
+            return self._generation
+
+    def put(self, user_id, credentials, generation=None):
+        """
+        Store credentials, unless they were read at a generation the user
+        has since been invalidated after
+        """
+        if self.ttl <= 0:
+            return
+        with self._lock:
+            if generation is not None and (
+                    generation < self._forgotten or self._invalidated.get(user_id, 0) > generation):
+                return
+            self._entries[user_id] = (time.monotonic(), dict(credentials))
+            self._entries.move_to_end(user_id)
+            while len(self._entries) > self.max_size:
+                self._entries.popitem(last=False)
+
+    def invalidate(self, user_id):
+        with self._lock:
+            self._generation += 1
+            self._invalidated[user_id] = self._generation
+            self._invalidated.move_to_end(user_id)
+            while len(self._invalidated) > self.max_size:
+                _, forgotten = self._invalidated.popitem(last=False)
+                self._forgotten = max(self._forgotten, forgotten)
+            if self._entries.pop(user_id, None) is not None:
+                self._stats['invalidations'] += 1
+
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+            self._invalidated.clear()
+            self._forgotten = self._generation
+
+    def stats(self):
+        with self._lock:
+            stats = dict(self._stats)
+            stats['size'] = len(self._entries)
+            stats['ttl'] = self.ttl
+            return stats
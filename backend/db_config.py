@@ -5,10 +5,20 @@ Supports both SQLite (development) and PostgreSQL (production)
 """
 
 import os
+import sqlite3
 import logging
+import threading
+import time
 
 logger = logging.getLogger(__name__)
 
+# Hot queries, compiled once per connection and then reused from each
+# sqlite3 connection's statement cache. The request path (auth_service)
+# only runs on SQLite.
+PREPARED_STATEMENTS = {
+    'user_credentials': 'SELECT apple_id, apple_password_encrypted FROM users WHERE id = ?',
+}
+
 
 def get_database_url():
     """
@@ -40,37 +50,226 @@ def is_postgres():
     return os.environ.get('DATABASE_URL') is not None
 
 
+def connect_postgres():
+    """Open a new psycopg2 connection to DATABASE_URL"""
+    import psycopg2
+    from urllib.parse import urlparse
+
+    result = urlparse(get_database_url())
+
+    conn = psycopg2.connect(
+        database=result.path[1:],
+        user=result.username,
+        password=result.password,
+        host=result.hostname,
+        port=result.port
+    )
+    logger.info("Connected to PostgreSQL")
+    return conn
+
+
+def connect_sqlite(database_path):
+    """
+    Open a new SQLite connection. check_same_thread is off because pooled
+    connections move between request threads (one at a time).
+    """
+    conn = sqlite3.connect(
+        database_path,
+        detect_types=sqlite3.PARSE_DECLTYPES,
+        check_same_thread=False
+    )
+    conn.row_factory = sqlite3.Row
+    logger.info(f"Connected to SQLite: {database_path}")
+    return conn
+
+
 def get_db_connection():
     """
     Get a raw database connection for direct SQL operations.
+    Request handlers should use get_connection_pool() instead.
 
     Returns:
         Connection object (sqlite3 or psycopg2)
     """
     if is_postgres():
-        import psycopg2
-        from urllib.parse import urlparse
-
-        database_url = get_database_url()
-        result = urlparse(database_url)
-
-        conn = psycopg2.connect(
-            database=result.path[1:],
-            user=result.username,
-            password=result.password,
-            host=result.hostname,
-            port=result.port
-        )
-        logger.info("Connected to PostgreSQL")
+        return connect_postgres()
+    return connect_sqlite(os.environ.get('DATABASE_PATH', 'users.db'))
+
+
+def execute_prepared(conn, name, params=()):
+    """
+    Run a statement from PREPARED_STATEMENTS on a sqlite3 connection and
+    return the cursor. Passing the same SQL text each time lets sqlite3
+    reuse the compiled statement from the connection's cache.
+    """
+    return conn.execute(PREPARED_STATEMENTS[name], params)
+
+
+class PoolExhausted(Exception):
+    """Raised when no connection is released within the pool timeout"""
+
+
+class ConnectionPool:
+    """
+    Thread-safe pool of database connections.
+
+    Holds up to max_size connections, min_size of them opened up front.
+    acquire() hands out the most recently used idle connection and blocks
+    for up to timeout seconds when all are checked out. A connection idle
+    for health_check_interval seconds or more is checked with SELECT 1
+    before reuse and replaced if the check fails. release() rolls back any
+    open transaction before the connection goes back to the pool.
+    """
+
+    def __init__(self, connect, min_size=1, max_size=10, timeout=10, health_check_interval=30):
+        self._connect = connect
+        self.min_size = min_size
+        self.max_size = max(max_size, 1)
+        self.timeout = timeout
+        self.health_check_interval = health_check_interval
+        self._idle = []
+        self._size = 0
+        self._cond = threading.Condition()
+        self._stats = {
+            'created': 0,
+            'reused': 0,
+            'discarded': 0,
+            'waits': 0,
+        }
+
+        for _ in range(min(min_size, self.max_size)):
+            self._size += 1
+            self._idle.append((self._create(), time.monotonic()))
+
+    def acquire(self):
+        """Check out a connection; raises PoolExhausted after timeout"""
+        deadline = time.monotonic() + self.timeout
+        with self._cond:
+            while not self._idle and self._size >= self.max_size:
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    raise PoolExhausted(f"No database connection free within {self.timeout}s")
+                self._stats['waits'] += 1
+                self._cond.wait(remaining)
+
+            if not self._idle:
+                # Reserve a slot for a new connection
+                self._size += 1
+                conn = None
+            else:
+                conn, last_used = self._idle.pop()
+
+        if conn is None:
+            return self._create()
+
+        if time.monotonic() - last_used >= self.health_check_interval and not self._healthy(conn):
+            logger.warning("Replacing unhealthy pooled database connection")
+            self._close(conn)
+            with self._cond:
+                self._stats['discarded'] += 1
+            return self._create()
+
+        with self._cond:
+            self._stats['reused'] += 1
         return conn
-    else:
-        import sqlite3
-        database_path = os.environ.get('DATABASE_PATH', 'users.db')
-        conn = sqlite3.connect(database_path)
-        conn.row_factory = sqlite3.Row
-        logger.info(f"Connected to SQLite: {database_path}")
+
+    def release(self, conn):
+        """Return a checked-out connection to the pool"""
+        try:
+            conn.rollback()
+        except Exception:
+            self.discard(conn)
+            return
+
+        with self._cond:
+            self._idle.append((conn, time.monotonic()))
+            self._cond.notify()
+
+    def discard(self, conn):
+        """Close a checked-out connection instead of returning it"""
+        self._close(conn)
+        with self._cond:
+            self._size -= 1
+            self._stats['discarded'] += 1
+            self._cond.notify()
+
+    def close(self):
+        """Close all idle connections"""
+        with self._cond:
+            idle, self._idle = self._idle, []
+            self._size -= len(idle)
+        for conn, _ in idle:
+            self._close(conn)
+
+    def stats(self):
+        with self._cond:
+            stats = dict(self._stats)
+            stats['size'] = self._size
+            stats['idle'] = len(self._idle)
+            stats['max_size'] = self.max_size
+            return stats
+
+    def _create(self):
+        # The caller has already reserved a slot in _size
+        try:
+            conn = self._connect()
+        except Exception:
+            with self._cond:
+                self._size -= 1
+                self._cond.notify()
+            raise
+        with self._cond:
+            self._stats['created'] += 1
         return conn
 
+    @staticmethod
+    def _healthy(conn):
+        try:
+            cursor = conn.cursor()
+            cursor.execute('SELECT 1')
+            cursor.fetchone()
+            cursor.close()
+            conn.rollback()
+            return True
+        except Exception:
+            return False
+
+    @staticmethod
+    def _close(conn):
+        try:
+            conn.close()
+        except Exception:
+            pass
+
+
+_pools = {}
+_pools_lock = threading.Lock()
+
+
+def get_connection_pool(database_path=None):
+    """
+    Get the process-wide pool for a SQLite file, DATABASE_PATH when no path
+    is given. Sized by DB_POOL_MIN_SIZE, DB_POOL_MAX_SIZE, DB_POOL_TIMEOUT
+    and DB_POOL_HEALTH_CHECK_INTERVAL.
+    """
+    path = database_path or os.environ.get('DATABASE_PATH', 'users.db')
+    key = ('sqlite', path)
+    connect = lambda: connect_sqlite(path)
+
+    with _pools_lock:
+        pool = _pools.get(key)
+        if pool is None:
+            pool = ConnectionPool(
+                connect,
+                min_size=int(os.environ.get('DB_POOL_MIN_SIZE', 1)),
+                max_size=int(os.environ.get('DB_POOL_MAX_SIZE', 10)),
+                timeout=float(os.environ.get('DB_POOL_TIMEOUT', 10)),
+                health_check_interval=float(os.environ.get('DB_POOL_HEALTH_CHECK_INTERVAL', 30))
+            )
+            _pools[key] = pool
+            logger.info(f"Created {key[0]} connection pool (max {pool.max_size})")
+        return pool
+
 
 def init_database_schema(conn):
     """
@@ -92,6 +291,12 @@ def init_database_schema(conn):
                 created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
             )
         ''')
+        cursor.execute('''
+            CREATE TABLE IF NOT EXISTS revoked_tokens (
+                token_hash VARCHAR(64) PRIMARY KEY,
+                expires_at BIGINT NOT NULL
+            )
+        ''')
         logger.info("PostgreSQL schema created/verified")
     else:
         # SQLite schema
@@ -104,6 +309,12 @@ def init_database_schema(conn):
                 created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
             )
         ''')
+        cursor.execute('''
+            CREATE TABLE IF NOT EXISTS revoked_tokens (
+                token_hash TEXT PRIMARY KEY,
+                expires_at INTEGER NOT NULL
+            )
+        ''')
         logger.info("SQLite schema created/verified")
 
     conn.commit()
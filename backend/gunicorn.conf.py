@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+"""
+Gunicorn configuration
+Runs the app on gevent workers so requests waiting on iCloud yield to
+other requests instead of each holding a worker process
+"""
+
+import os
+
+bind = f"0.0.0.0:{os.environ.get('PORT', '8080')}"
+
+# Each gevent worker serves up to worker_connections requests at once;
+# processes only need to cover CPU cores, not concurrent iCloud calls.
+# Set GUNICORN_WORKER_CLASS=sync to fall back to one request per process.
+worker_class = os.environ.get('GUNICORN_WORKER_CLASS', 'gevent')
+workers = int(os.environ.get('WEB_CONCURRENCY', 2))
+# app.py splits rate limits across this many processes without a shared store
+os.environ['WEB_CONCURRENCY'] = str(workers)
+worker_connections = int(os.environ.get('GUNICORN_WORKER_CONNECTIONS', 1000))
+
+timeout = int(os.environ.get('GUNICORN_TIMEOUT', 60))
+graceful_timeout = 30
+keepalive = 5
+
+
+def post_fork(server, worker):
+    """Make psycopg2 cooperative so PostgreSQL queries do not block the worker"""
+    if worker_class != 'gevent':
+        return
+    try:
+        from psycogreen.gevent import patch_psycopg
+    except ImportError:
+        server.log.warning("psycogreen not installed; PostgreSQL calls will block gevent workers")
+        return
+    patch_psycopg()
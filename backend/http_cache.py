@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""
+Conditional GET and response compression
+Strong ETags from a hash of the response body, weak ones from a content
+version known before the body is built, If-None-Match matching for 304
+replies, and gzip/deflate chosen from Accept-Encoding
+"""
+
+import gzip
+import hashlib
+import zlib
+
+# Preferred first when the client weighs them equally
+ENCODINGS = ('gzip', 'deflate')
+
+
+def strong_etag(body, encoding=None):
+    """
+    Quoted strong ETag for a response body. Each content-coding of the same
+    body is a different representation, so it gets its own tag.
+    """
+    digest = hashlib.sha256(body).hexdigest()[:32]
+    if encoding:
+        return f'"{digest}-{encoding}"'
+    return f'"{digest}"'
+
+
+def version_etag(version, variant=''):
+    """
+    Quoted weak ETag for a resource at a content version, available before
+    the body is built. variant names whatever else shapes the body, such as
+    the endpoint and its query arguments. The tag is weak because it holds
+    across content-codings and across bodies that differ only in how they
+    bring the client to that version.
+    """
+    digest = hashlib.sha256(f"{version}|{variant}".encode()).hexdigest()[:32]
+    return f'W/"{digest}"'
+
+
+def _opaque_tag(etag):
+    """Strip W/ and any -coding suffix so every variant of a body compares equal"""
+    if etag.startswith('W/'):
+        etag = etag[2:]
+    etag = etag.strip('"')
+    for encoding in ENCODINGS:
+        suffix = f'-{encoding}'
+        if etag.endswith(suffix):
+            return etag[:-len(suffix)]
+    return etag
+
+
+def if_none_match(header, etag):
+    """
+    True when an If-None-Match header matches etag. Uses the weak
+    comparison RFC 9110 asks for, and treats tags for other codings of the
+    same body as matching.
+    """
+    if not header:
+        return False
+    if header.strip() == '*':
+        return True
+    wanted = _opaque_tag(etag)
+    return any(_opaque_tag(tag.strip()) == wanted for tag in header.split(',') if tag.strip())
+
+
+def choose_encoding(accept_encoding):
+    """Return the best of ENCODINGS the client accepts, or None for identity"""
+    if not accept_encoding:
+        return None
+    weights = {}
+    for part in accept_encoding.split(','):
+        coding, _, params = part.strip().partition(';')
+        coding = coding.strip().lower()
+        q = 1.0
+        params = params.strip()
+        if params.startswith('q='):
+            try:
+                q = float(params[2:])
+            except ValueError:
+                q = 0.0
+        weights[coding] = q
+
+    best = None
+    best_q = 0.0
+    for encoding in ENCODINGS:
+        q = weights.get(encoding, weights.get('*', 0.0))
+        if q > best_q:
+            best, best_q = encoding, q
+    return best
+
+
+def compress(body, encoding, level=6):
+    if encoding == 'gzip':
+        # mtime=0 keeps the output, and so its ETag, stable between calls
+        return gzip.compress(body, compresslevel=level, mtime=0)
+    if encoding == 'deflate':
+        # HTTP "deflate" is the zlib format, not raw deflate
+        return zlib.compress(body, level)
+    raise ValueError(f"Unsupported encoding: {encoding}")
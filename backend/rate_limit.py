@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""
+Rate limit storage settings
+Chooses a limiter strategy the configured storage can run, and without a
+shared store splits each limit between worker processes so a deploy with
+N workers does not hand clients N times the configured limits
+"""
+
+import logging
+import math
+import re
+
+logger = logging.getLogger(__name__)
+
+MEMORY_STORAGE_URI = 'memory://'
+
+# limits' memcached storage has no moving window
+FIXED_WINDOW_ONLY_SCHEMES = ('memcached',)
+
+_LIMIT_COUNT = re.compile(r'(\d+)(\s*(?:/|per\b))')
+
+
+def storage_scheme(storage_uri):
+    return storage_uri.split('://', 1)[0].lower()
+
+
+def is_shared(storage_uri):
+    """True when every worker process counts against the same store"""
+    return storage_scheme(storage_uri) != 'memory'
+
+
+def limiter_strategy(storage_uri, requested):
+    """The requested strategy, or fixed-window where storage cannot do better"""
+    if requested == 'moving-window' and storage_scheme(storage_uri) in FIXED_WINDOW_ONLY_SCHEMES:
+        logger.warning(f"{storage_scheme(storage_uri)} storage has no moving window; using fixed-window")
+        return 'fixed-window'
+    return requested
+
+
+def per_process_limit(limit, processes):
+    """
+    Each process's share of a limit string such as "200 per day;50 per
+    hour", rounded up so no limit drops to zero
+    """
+    if processes <= 1:
+        return limit
+    return _LIMIT_COUNT.sub(
+        lambda match: f"{math.ceil(int(match.group(1)) / processes)}{match.group(2)}",
+        limit
+    )
+
+
+def limit_processes(storage_uri, workers):
+    """How many ways each limit is split: one per worker unless the store is shared"""
+    return 1 if is_shared(storage_uri) else max(workers, 1)
+
+
+def limiter_options(storage_uri, strategy):
+    """Storage keyword arguments for flask_limiter.Limiter"""
+    return {
+        'storage_uri': storage_uri,
+        'strategy': limiter_strategy(storage_uri, strategy),
+        # Keep serving, with per-process counters, if the shared store goes down
+        'in_memory_fallback_enabled': is_shared(storage_uri),
+    }
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Per-user cache of reminder lists and reminders
+Serves repeat reads from memory and uses iCloud collection ctags to
+refresh only the lists that actually changed
+"""
+
+import threading
+import time
+from collections import OrderedDict
+
+# Values for the Cache-Status response header
+CACHE_HIT = 'HIT'
+CACHE_MISS = 'MISS'
+CACHE_REVALIDATED = 'REVALIDATED'
+CACHE_STALE = 'STALE'
+
+
+def collection_ctag(collection):
+    """Return the collection's change tag, or None if iCloud did not send one"""
+    ctag = getattr(collection, 'ctag', None)
+    if isinstance(ctag, (str, int)):
+        return ctag
+    return None
+
+
+class CacheEntry:
+    """Cached payload plus the ctag it was built from"""
+
+    def __init__(self, data, ctag=None):
+        self.data = data
+        self.ctag = ctag
+        self.fetched_at = time.monotonic()
+
+    def age(self):
+        return time.monotonic() - self.fetched_at
+
+    def touch(self):
+        """Mark the entry as confirmed current by iCloud"""
+        self.fetched_at = time.monotonic()
+
+
+class _UserCache:
+    def __init__(self):
+        self.lists = None
+        self.reminders = {}
+
+
+class ReminderCache:
+    """
+    Thread-safe cache keyed by user_id.
+
+    Entries younger than max_staleness seconds are served without contacting
+    iCloud. Older entries are revalidated: a reminders entry whose ctag still
+    matches the collection is reused without iterating the collection.
+    For a further stale_while_revalidate seconds an entry may be served as
+    is while the revalidation runs in the background.
+    """
+
+    def __init__(self, max_staleness=30, max_users=1000, stale_while_revalidate=0):
+        self.max_staleness = max_staleness
+        self.stale_while_revalidate = stale_while_revalidate
+        self.max_users = max_users
+        self._users = OrderedDict()
+        self._lock = threading.Lock()
+        self._stats = {CACHE_HIT: 0, CACHE_MISS: 0, CACHE_REVALIDATED: 0, CACHE_STALE: 0}
+
+    def is_fresh(self, entry):
+        return entry is not None and entry.age() <= self.max_staleness
+
+    def is_servable_stale(self, entry):
+        """True if a stale entry may still be served while it is refreshed"""
+        if entry is None or self.stale_while_revalidate <= 0:
+            return False
+        return entry.age() <= self.max_staleness + self.stale_while_revalidate
+
+    def get_lists(self, user_id):
+        with self._lock:
+            user = self._users.get(user_id)
+            return user.lists if user else None
+
+    def store_lists(self, user_id, lists, ctags):
+        """
+        Store the list summaries and drop cached reminders for any list
+        whose ctag changed or that no longer exists.
+        """
+        with self._lock:
+            user = self._user_locked(user_id)
+            user.lists = CacheEntry(lists)
+            for list_id in list(user.reminders):
+                entry = user.reminders[list_id]
+                if list_id not in ctags or ctags[list_id] is None or ctags[list_id] != entry.ctag:
+                    del user.reminders[list_id]
+
+    def get_reminders(self, user_id, list_id):
+        with self._lock:
+            user = self._users.get(user_id)
+            return user.reminders.get(list_id) if user else None
+
+    def store_reminders(self, user_id, list_id, reminders, ctag):
+        with self._lock:
+            user = self._user_locked(user_id)
+            entry = CacheEntry(reminders, ctag)
+            user.reminders[list_id] = entry
+            return entry
+
+    def invalidate_list(self, user_id, list_id):
+        """Forget a list after it was modified through this service"""
+        with self._lock:
+            user = self._users.get(user_id)
+            if user:
+                user.reminders.pop(list_id, None)
+
+    def invalidate_user(self, user_id):
+        with self._lock:
+            self._users.pop(user_id, None)
+
+    def clear(self):
+        with self._lock:
+            self._users.clear()
+            for status in self._stats:
+                self._stats[status] = 0
+
+    def record(self, status):
+        """Count a response by Cache-Status"""
+        with self._lock:
+            self._stats[status] += 1
+
+    def stats(self):
+        with self._lock:
+            total = sum(self._stats.values())
+            served = total - self._stats[CACHE_MISS]
+            return {
+                'users': len(self._users),
+                'max_staleness': self.max_staleness,
+                'stale_while_revalidate': self.stale_while_revalidate,
+                'hits': self._stats[CACHE_HIT],
+                'revalidated': self._stats[CACHE_REVALIDATED],
+                'stale': self._stats[CACHE_STALE],
+                'misses': self._stats[CACHE_MISS],
+                'hit_rate': round(served / total, 4) if total else 0.0,
+            }
+
+    def _user_locked(self, user_id):
+        user = self._users.get(user_id)
+        if user is None:
+            user = _UserCache()
+            self._users[user_id] = user
+            while len(self._users) > self.max_users:
+                self._users.popitem(last=False)
+        self._users.move_to_end(user_id)
+        return user
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Per-session lookup index for iCloud collections and reminders
+Replaces linear scans of service.reminders.collections and of each
+collection with guid hash maps that are rebuilt only when stale
+"""
+
+import threading
+from collections import OrderedDict
+
+from reminder_cache import collection_ctag
+
+
+class _ReminderMap:
+    def __init__(self, collection, ctag, reminders):
+        self.collection = collection
+        self.ctag = ctag
+        self.reminders = reminders
+        self.by_guid = {reminder.get('guid'): reminder for reminder in reminders}
+
+
+class ReminderIndex:
+    """
+    guid -> collection and guid -> reminder maps for one iCloud session.
+
+    A reminder map stays valid while it was built from the same collection
+    object and the collection ctag has not moved.
+    """
+
+    def __init__(self, service):
+        self.service = service
+        self._lock = threading.RLock()
+        self._collections_source = None
+        self._collections = {}
+        self._maps = {}
+        self.rebuilds = 0
+
+    def collection(self, list_id):
+        """Return the collection with this guid, or None"""
+        with self._lock:
+            source = self.service.reminders.collections
+            if source is not self._collections_source or list_id not in self._collections:
+                self._collections = {col.guid: col for col in source}
+                self._collections_source = source
+            return self._collections.get(list_id)
+
+    def reminders(self, collection):
+        """
+        Return the raw reminders of a collection. Collections without a
+        ctag are always re-read since there is no way to tell they changed.
+        """
+        with self._lock:
+            entry = self._current_map(collection)
+            if entry is None or entry.ctag is None:
+                entry = self._rebuild(collection)
+            return entry.reminders
+
+    def reminder(self, collection, reminder_id):
+        """Return the reminder with this guid, or None"""
+        with self._lock:
+            entry = self._current_map(collection)
+            if entry is not None and reminder_id in entry.by_guid:
+                return entry.by_guid[reminder_id]
+            # Unknown guid: it may have been added since the map was built
+            return self._rebuild(collection).by_guid.get(reminder_id)
+
+    def invalidate(self, list_id):
+        with self._lock:
+            self._maps.pop(list_id, None)
+
+    def _current_map(self, collection):
+        entry = self._maps.get(collection.guid)
+        if entry is None or entry.collection is not collection:
+            return None
+        if entry.ctag != collection_ctag(collection):
+            return None
+        return entry
+
+    def _rebuild(self, collection):
+        entry = _ReminderMap(collection, collection_ctag(collection), list(collection))
+        self._maps[collection.guid] = entry
+        self.rebuilds += 1
+        return entry
+
+
+class ReminderIndexRegistry:
+    """Thread-safe ReminderIndex per user, tied to the user's current session"""
+
+    def __init__(self, max_users=1000):
+        self.max_users = max_users
+        self._indexes = OrderedDict()
+        self._lock = threading.Lock()
+
+    def get(self, user_id, service):
+        with self._lock:
+            index = self._indexes.get(user_id)
+            if index is None or index.service is not service:
+                index = ReminderIndex(service)
+                self._indexes[user_id] = index
+                while len(self._indexes) > self.max_users:
+                    self._indexes.popitem(last=False)
+            self._indexes.move_to_end(user_id)
+            return index
+
+    def forget(self, user_id):
+        with self._lock:
+            self._indexes.pop(user_id, None)
+
+    def clear(self):
+        with self._lock:
+            self._indexes.clear()
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""
+Per-user iCloud session pool
+Keeps logged-in PyiCloudService instances alive between requests so a
+watch tap does not pay for a full iCloud login every time
+"""
+
+import hashlib
+import logging
+import os
+import threading
+import time
+import weakref
+from collections import OrderedDict
+
+logger = logging.getLogger(__name__)
+
+
+class _PoolEntry:
+    """A pooled service plus the bookkeeping needed for eviction"""
+
+    def __init__(self, service, fingerprint):
+        self.service = service
+        self.fingerprint = fingerprint
+        self.created_at = time.monotonic()
+        self.last_used = self.created_at
+
+
+class ICloudSessionPool:
+    """
+    Thread-safe LRU pool of iCloud sessions keyed by user_id.
+
+    Entries are dropped when the pool exceeds max_size (least recently used
+    first) or when they have been idle for longer than idle_ttl seconds.
+    Logins for different users run concurrently; concurrent requests for the
+    same user wait for a single login instead of starting their own.
+    """
+
+    def __init__(self, factory, max_size=100, idle_ttl=900, cookie_root=None):
+        self._factory = factory
+        self.max_size = max_size
+        self.idle_ttl = idle_ttl
+        self.cookie_root = cookie_root
+        self._entries = OrderedDict()
+        self._lock = threading.Lock()
+        # Held only while a login for that user is running or waited on,
+        # so the map does not grow with every user the process has seen
+        self._user_locks = weakref.WeakValueDictionary()
+        self._stats = {
+            'hits': 0,
+            'misses': 0,
+            'logins': 0,
+            'login_failures': 0,
+            'evictions': 0,
+            'expirations': 0,
+            'invalidations': 0,
+        }
+
+    @staticmethod
+    def fingerprint(apple_id, apple_password):
+        """Hash credentials so a password change forces a fresh login"""
+        digest = hashlib.sha256(f"{apple_id}\0{apple_password}".encode())
+        return digest.hexdigest()
+
+    def cookie_directory_for(self, user_id):
+        """Per-user pyicloud cookie/session directory, created on demand"""
+        if not self.cookie_root:
+            return None
+        path = os.path.join(self.cookie_root, str(user_id))
+        os.makedirs(path, mode=0o700, exist_ok=True)
+        return path
+
+    def get(self, user_id, apple_id, apple_password):
+        """Return a pooled service for user_id, logging in if needed"""
+        fingerprint = self.fingerprint(apple_id, apple_password)
+
+        with self._lock:
+            entry = self._lookup_locked(user_id, fingerprint)
+            if entry:
+                self._stats['hits'] += 1
+                return entry.service
+            user_lock = self._user_locks.get(user_id)
+            if user_lock is None:
+                user_lock = self._user_locks[user_id] = threading.Lock()
+
+        with user_lock:
+            # Another thread may have finished the login while we waited
+            with self._lock:
+                entry = self._lookup_locked(user_id, fingerprint)
+                if entry:
+                    self._stats['hits'] += 1
+                    return entry.service
+                self._stats['misses'] += 1
+
+            try:
+                service = self._factory(
+                    apple_id,
+                    apple_password,
+                    self.cookie_directory_for(user_id)
+                )
+            except Exception:
+                with self._lock:
+                    self._stats['login_failures'] += 1
+                raise
+
+            with self._lock:
+                self._stats['logins'] += 1
+                self._entries[user_id] = _PoolEntry(service, fingerprint)
+                self._entries.move_to_end(user_id)
+                self._evict_locked()
+            return service
+
+    def invalidate(self, user_id):
+        """Drop a user's session (e.g. after an iCloud auth error)"""
+        with self._lock:
+            if self._entries.pop(user_id, None) is not None:
+                self._stats['invalidations'] += 1
+
+    def clear(self):
+        """Drop every pooled session"""
+        with self._lock:
+            self._entries.clear()
+            self._user_locks.clear()
+
+    def stats(self):
+        """Snapshot of pool size and reuse counters"""
+        with self._lock:
+            self._expire_locked()
+            lookups = self._stats['hits'] + self._stats['misses']
+            stats = dict(self._stats)
+            stats['size'] = len(self._entries)
+            stats['max_size'] = self.max_size
+            stats['idle_ttl'] = self.idle_ttl
+            stats['hit_rate'] = round(self._stats['hits'] / lookups, 4) if lookups else 0.0
+            return stats
+
+    def _lookup_locked(self, user_id, fingerprint):
+        entry = self._entries.get(user_id)
+        if entry is None:
+            return None
+
+        now = time.monotonic()
+        if self.idle_ttl and now - entry.last_used > self.idle_ttl:
+            del self._entries[user_id]
+            self._stats['expirations'] += 1
+            return None
+
+        if entry.fingerprint != fingerprint:
+            # Credentials changed since this session was created
+            del self._entries[user_id]
+            self._stats['invalidations'] += 1
+            return None
+
+        entry.last_used = now
+        self._entries.move_to_end(user_id)
+        return entry
+
+    def _expire_locked(self):
+        if not self.idle_ttl:
+            return
+        cutoff = time.monotonic() - self.idle_ttl
+        expired = [uid for uid, entry in self._entries.items() if entry.last_used < cutoff]
+        for uid in expired:
+            del self._entries[uid]
+            self._stats['expirations'] += 1
+
+    def _evict_locked(self):
+        self._expire_locked()
+        while len(self._entries) > self.max_size:
+            user_id, _ = self._entries.popitem(last=False)
+            self._stats['evictions'] += 1
+            logger.info(f"Evicted iCloud session for user {user_id}")
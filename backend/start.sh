@@ -2,4 +2,5 @@
 # Start script for Railway deployment
 # This ensures the PORT environment variable is properly expanded
 
-exec gunicorn app:app --workers 4 --timeout 60 --bind "0.0.0.0:${PORT}"
+# Workers, worker class and timeouts are set in gunicorn.conf.py
+exec gunicorn app:app --config gunicorn.conf.py
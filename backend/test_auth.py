@@ -4,11 +4,15 @@ Unit tests for multi-user authentication
 Following TDD approach
 """
 
+import os
+import shutil
+import tempfile
 import unittest
 from unittest.mock import Mock, patch, MagicMock
 import json
 import jwt
 from datetime import datetime, timedelta
+from db_config import get_connection_pool, execute_prepared
 from auth_service import (
     app,
     init_db,
@@ -17,7 +21,15 @@ from auth_service import (
     encrypt_password,
     decrypt_password,
     generate_token,
-    verify_token
+    verify_token,
+    get_user_credentials,
+    update_apple_credentials,
+    credential_cache,
+    authenticate_token,
+    revoke_token,
+    token_cache,
+    get_db,
+    release_db
 )
 
 
@@ -163,6 +175,131 @@ class TestUserLogin(unittest.TestCase):
         self.assertEqual(response.status_code, 401)
         self.assertIn('error', data)
 
+    def test_login_rejects_old_password_after_change(self):
+        """Should not accept a cached password once credentials change"""
+        # Arrange
+        authenticate_user('testuser', 'test@icloud.com', 'test_password')
+        update_apple_credentials(1, 'test@icloud.com', 'new_password')
+
+        # Act
+        old = authenticate_user('testuser', 'test@icloud.com', 'test_password')
+        new = authenticate_user('testuser', 'test@icloud.com', 'new_password')
+
+        # Assert
+        self.assertIsNone(old)
+        self.assertEqual(new['id'], 1)
+
+
+class TestCredentialCache(unittest.TestCase):
+    """Test cases for serving decrypted credentials from the cache"""
+
+    def setUp(self):
+        self.app = app
+        self.app.config['TESTING'] = True
+        self.app.config['DATABASE'] = ':memory:'
+        self.app_context = self.app.app_context()
+        self.app_context.push()
+        init_db()
+        credential_cache.clear()
+        self.user_id, _ = create_user('testuser', 'test@icloud.com', 'test_password')
+
+    def tearDown(self):
+        self.app_context.pop()
+
+    @patch('auth_service.decrypt_password', wraps=decrypt_password)
+    def test_repeat_lookups_skip_decrypt(self, mock_decrypt):
+        """Should decrypt once and serve later lookups from the cache"""
+        # Act
+        first = get_user_credentials(self.user_id)
+        second = get_user_credentials(self.user_id)
+
+        # Assert
+        self.assertEqual(first, second)
+        self.assertEqual(second['apple_password'], 'test_password')
+        self.assertEqual(mock_decrypt.call_count, 1)
+
+    def test_update_invalidates_cached_credentials(self):
+        """Should return the new password right after an update"""
+        # Arrange
+        get_user_credentials(self.user_id)
+
+        # Act
+        updated = update_apple_credentials(self.user_id, 'new@icloud.com', 'new_password')
+        credentials = get_user_credentials(self.user_id)
+
+        # Assert
+        self.assertTrue(updated)
+        self.assertEqual(credentials, {
+            'apple_id': 'new@icloud.com',
+            'apple_password': 'new_password'
+        })
+
+    def test_update_racing_lookup_not_cached(self):
+        """Should not cache the old password when an update lands mid-lookup"""
+        # Arrange
+        def read_then_update(db, name, params):
+            row = execute_prepared(db, name, params).fetchone()
+            update_apple_credentials(self.user_id, 'new@icloud.com', 'new_password')
+            return Mock(fetchone=Mock(return_value=row))
+
+        # Act
+        with patch('auth_service.execute_prepared', side_effect=read_then_update):
+            raced = get_user_credentials(self.user_id)
+        credentials = get_user_credentials(self.user_id)
+
+        # Assert
+        self.assertEqual(raced['apple_password'], 'test_password')
+        self.assertEqual(credentials['apple_password'], 'new_password')
+
+    def test_update_unknown_user(self):
+        """Should report a missing user"""
+        # Act / Assert
+        self.assertFalse(update_apple_credentials(999, 'new@icloud.com', 'new_password'))
+
+
+class TestConnectionRelease(unittest.TestCase):
+    """Test cases for returning pooled connections before iCloud calls"""
+
+    def setUp(self):
+        self.db_dir = tempfile.mkdtemp()
+        self.app = app
+        self.app.config['TESTING'] = True
+        self.app.config['DATABASE'] = os.path.join(self.db_dir, 'users.db')
+        self.app_context = self.app.app_context()
+        self.app_context.push()
+        init_db()
+        self.user_id, _ = create_user('testuser', 'test@icloud.com', 'test_password')
+        credential_cache.clear()
+
+    def tearDown(self):
+        self.app_context.pop()
+        shutil.rmtree(self.db_dir, ignore_errors=True)
+
+    def test_credentials_lookup_releases_connection(self):
+        """Should give the connection back once the credentials are read"""
+        # Arrange
+        pool = get_connection_pool(self.app.config['DATABASE'])
+        get_db()
+
+        # Act
+        credentials = get_user_credentials(self.user_id)
+
+        # Assert
+        self.assertEqual(credentials['apple_id'], 'test@icloud.com')
+        self.assertEqual(pool.stats()['idle'], pool.stats()['size'])
+
+    def test_get_db_checks_out_again_after_release(self):
+        """Should hand out a working connection after an early release"""
+        # Arrange
+        get_db()
+        release_db()
+
+        # Act
+        row = get_db().execute('SELECT COUNT(*) AS n FROM users').fetchone()
+
+        # Assert
+        self.assertEqual(row['n'], 1)
+
 
 class TestPasswordEncryption(unittest.TestCase):
     """Test cases for password encryption/decryption"""
@@ -248,6 +385,78 @@ class TestJWTTokens(unittest.TestCase):
         self.assertIsNone(result)
 
 
+class TestTokenRevocation(unittest.TestCase):
+    """Test cases for the verified-token fast path and revocation"""
+
+    def setUp(self):
+        self.app = app
+        self.app.config['TESTING'] = True
+        self.app.config['DATABASE'] = ':memory:'
+        self.app.config['SECRET_KEY'] = 'test_secret_key'
+        self.app_context = self.app.app_context()
+        self.app_context.push()
+        init_db()
+        token_cache.clear()
+
+    def tearDown(self):
+        self.app_context.pop()
+
+    @patch('auth_service.jwt.decode', wraps=jwt.decode)
+    def test_repeat_token_skips_signature_check(self, mock_decode):
+        """Should verify the signature once for repeated requests"""
+        # Arrange
+        token = generate_token(123)
+
+        # Act
+        first = authenticate_token(token)
+        second = authenticate_token(token)
+
+        # Assert
+        self.assertEqual((first, second), (123, 123))
+        self.assertEqual(mock_decode.call_count, 1)
+
+    def test_revoked_token_rejected(self):
+        """Should reject a token after it is revoked"""
+        # Arrange
+        token = generate_token(123)
+        authenticate_token(token)
+
+        # Act
+        revoke_token(token)
+
+        # Assert
+        self.assertIsNone(authenticate_token(token))
+
+    def test_revocation_checked_after_cache_miss(self):
+        """Should reject a token revoked by another process once the cache misses"""
+        # Arrange
+        token = generate_token(123)
+        revoke_token(token)
+        token_cache.clear()
+
+        # Act
+        result = authenticate_token(token)
+
+        # Assert
+        self.assertIsNone(result)
+
+    def test_revoking_one_token_keeps_others(self):
+        """Should only revoke the token that logged out"""
+        # Arrange
+        watch_token = generate_token(123)
+        other_token = jwt.encode(
+            {'user_id': 123, 'exp': datetime.utcnow() + timedelta(days=1)},
+            'test_secret_key',
+            algorithm='HS256'
+        )
+
+        # Act
+        revoke_token(watch_token)
+
+        # Assert
+        self.assertEqual(authenticate_token(other_token), 123)
+
+
 # Note: TestProtectedEndpoints will be added after integrating auth_service with icloud_service
 
 
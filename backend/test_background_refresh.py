@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the background cache refresher
+Following TDD approach
+"""
+
+import threading
+import unittest
+from unittest.mock import Mock
+
+from background_refresh import BackgroundRefresher
+
+
+class TestBackgroundRefresher(unittest.TestCase):
+    """Test cases for running refreshes off the request path"""
+
+    def setUp(self):
+        self.refresher = BackgroundRefresher(max_workers=2)
+
+    def tearDown(self):
+        self.refresher.shutdown()
+
+    def test_runs_refresh_in_background(self):
+        """Should run the refresh function with its arguments"""
+        # Arrange
+        refresh = Mock()
+
+        # Act
+        scheduled = self.refresher.schedule((1, 'lists'), refresh, 1)
+        self.refresher.wait_idle(timeout=5)
+
+        # Assert
+        self.assertTrue(scheduled)
+        refresh.assert_called_once_with(1)
+        self.assertEqual(self.refresher.stats()['completed'], 1)
+
+    def test_coalesces_pending_refreshes_for_same_key(self):
+        """Should not start a second refresh while one is pending for the key"""
+        # Arrange
+        release = threading.Event()
+        refresh = Mock(side_effect=lambda: release.wait(5))
+
+        # Act
+        first = self.refresher.schedule((1, 'reminders', 'list-123'), refresh)
+        second = self.refresher.schedule((1, 'reminders', 'list-123'), refresh)
+        other = self.refresher.schedule((2, 'reminders', 'list-123'), refresh)
+        release.set()
+        self.refresher.wait_idle(timeout=5)
+
+        # Assert
+        self.assertTrue(first)
+        self.assertFalse(second)
+        self.assertTrue(other)
+        self.assertEqual(refresh.call_count, 2)
+        self.assertEqual(self.refresher.stats()['coalesced'], 1)
+
+    def test_failed_refresh_releases_key(self):
+        """Should count failures and allow the key to be refreshed again"""
+        # Arrange
+        refresh = Mock(side_effect=Exception('iCloud unavailable'))
+        self.refresher.schedule((1, 'lists'), refresh)
+        self.refresher.wait_idle(timeout=5)
+
+        # Act
+        scheduled = self.refresher.schedule((1, 'lists'), refresh)
+        self.refresher.wait_idle(timeout=5)
+
+        # Assert
+        self.assertTrue(scheduled)
+        self.assertEqual(self.refresher.stats()['failed'], 2)
+        self.assertFalse(self.refresher.is_pending((1, 'lists')))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the reminders change feed
+Following TDD approach
+"""
+
+import unittest
+
+from change_feed import ChangeFeed, encode_cursor, decode_cursor
+
+
+def reminder(reminder_id, title='Task', completed=False):
+    return {'id': reminder_id, 'title': title, 'completed': completed}
+
+
+class TestChangeDetection(unittest.TestCase):
+    """Test cases for diffing list snapshots"""
+
+    def setUp(self):
+        self.feed = ChangeFeed()
+        self.token = self.feed.observe(1, 'list-123', [reminder('r1'), reminder('r2')])
+
+    def test_no_changes_since_current_token(self):
+        """Should return an empty change set for an up-to-date client"""
+        self.assertEqual(self.feed.changes_since(1, 'list-123', self.token), [])
+
+    def test_reports_each_change_type(self):
+        """Should classify added, modified, completed and deleted reminders"""
+        # Act
+        self.feed.observe(1, 'list-123', [
+            reminder('r1', completed=True),
+            reminder('r3', title='New task')
+        ])
+        self.feed.observe(1, 'list-123', [
+            reminder('r1', completed=True),
+            reminder('r3', title='Renamed task')
+        ])
+        changes = self.feed.changes_since(1, 'list-123', self.token)
+
+        # Assert
+        by_type = {change['type']: change for change in changes}
+        self.assertEqual(by_type['completed']['reminder']['id'], 'r1')
+        self.assertEqual(by_type['added']['reminder']['title'], 'Renamed task')
+        self.assertEqual(by_type['deleted']['id'], 'r2')
+        self.assertEqual(len(changes), 3)
+
+    def test_title_edit_is_modified(self):
+        """Should report non-completion edits as modified"""
+        # Act
+        self.feed.observe(1, 'list-123', [reminder('r1', title='Edited'), reminder('r2')])
+        changes = self.feed.changes_since(1, 'list-123', self.token)
+
+        # Assert
+        self.assertEqual(changes, [{'type': 'modified', 'reminder': reminder('r1', title='Edited')}])
+
+    def test_added_then_deleted_cancels_out(self):
+        """Should drop reminders that appeared and vanished between syncs"""
+        # Act
+        self.feed.observe(1, 'list-123', [reminder('r1'), reminder('r2'), reminder('r3')])
+        self.feed.observe(1, 'list-123', [reminder('r1'), reminder('r2')])
+
+        # Assert
+        self.assertEqual(self.feed.changes_since(1, 'list-123', self.token), [])
+
+    def test_new_token_excludes_old_changes(self):
+        """Should only return changes after the given token"""
+        # Arrange
+        self.feed.observe(1, 'list-123', [reminder('r1')])
+        token = self.feed.observe(1, 'list-123', [reminder('r1')])
+
+        # Act
+        self.feed.observe(1, 'list-123', [reminder('r1', completed=True)])
+        changes = self.feed.changes_since(1, 'list-123', token)
+
+        # Assert
+        self.assertEqual([change['type'] for change in changes], ['completed'])
+
+
+class TestTokensAcrossProcesses(unittest.TestCase):
+    """Test cases for tokens minted by one worker process and used with another"""
+
+    def setUp(self):
+        self.first = ChangeFeed()
+        self.second = ChangeFeed()
+
+    def test_same_content_gives_same_token(self):
+        """Should derive the token from the list, not from the process"""
+        # Act
+        first = self.first.observe(1, 'list-123', [reminder('r1'), reminder('r2')])
+        second = self.second.observe(1, 'list-123', [reminder('r1'), reminder('r2')])
+
+        # Assert
+        self.assertEqual(first, second)
+
+    def test_up_to_date_token_accepted_by_other_process(self):
+        """Should answer an empty change set for another worker's current token"""
+        # Arrange
+        token = self.first.observe(1, 'list-123', [reminder('r1')])
+        self.second.observe(1, 'list-123', [reminder('r1')])
+
+        # Act / Assert
+        self.assertEqual(self.second.changes_since(1, 'list-123', token), [])
+
+    def test_delta_from_process_that_saw_both_versions(self):
+        """Should resolve another worker's older token against its own log"""
+        # Arrange
+        token = self.first.observe(1, 'list-123', [reminder('r1')])
+        self.second.observe(1, 'list-123', [reminder('r1')])
+        self.second.observe(1, 'list-123', [reminder('r1', completed=True)])
+
+        # Act
+        changes = self.second.changes_since(1, 'list-123', token)
+
+        # Assert
+        self.assertEqual(changes, [{'type': 'completed', 'reminder': reminder('r1', completed=True)}])
+
+    def test_other_list_changes_do_not_move_token(self):
+        """Should keep a list's token while another list of the user changes"""
+        # Arrange
+        token = self.first.observe(1, 'list-123', [reminder('r1')])
+
+        # Act
+        self.first.observe(1, 'list-456', [reminder('r9')])
+        self.first.observe(1, 'list-456', [reminder('r9', completed=True)])
+
+        # Assert
+        self.assertEqual(self.first.observe(1, 'list-123', [reminder('r1')]), token)
+        self.assertEqual(self.first.changes_since(1, 'list-123', token), [])
+
+
+class TestCursors(unittest.TestCase):
+    """Test cases for pagination cursors bound to a list's sync token"""
+
+    def test_cursor_continues_on_other_process(self):
+        """Should decode a cursor minted by another worker for the same list"""
+        # Arrange
+        reminders = [reminder('r1'), reminder('r2'), reminder('r3')]
+        cursor = encode_cursor(2, ChangeFeed().observe(1, 'list-123', reminders))
+
+        # Act
+        offset = decode_cursor(cursor, ChangeFeed().observe(1, 'list-123', list(reminders)))
+
+        # Assert
+        self.assertEqual(offset, 2)
+
+    def test_cursor_survives_other_list_changes(self):
+        """Should keep a cursor valid while another list of the user changes"""
+        # Arrange
+        feed = ChangeFeed()
+        cursor = encode_cursor(1, feed.observe(1, 'list-123', [reminder('r1'), reminder('r2')]))
+        feed.observe(1, 'list-456', [reminder('r9', completed=True)])
+
+        # Act
+        offset = decode_cursor(cursor, feed.observe(1, 'list-123', [reminder('r1'), reminder('r2')]))
+
+        # Assert
+        self.assertEqual(offset, 1)
+
+    def test_cursor_rejected_after_list_changes(self):
+        """Should return None once the list the cursor came from changed"""
+        # Arrange
+        feed = ChangeFeed()
+        cursor = encode_cursor(1, feed.observe(1, 'list-123', [reminder('r1'), reminder('r2')]))
+
+        # Act
+        offset = decode_cursor(cursor, feed.observe(1, 'list-123', [reminder('r2')]))
+
+        # Assert
+        self.assertIsNone(offset)
+
+    def test_malformed_cursor_raises(self):
+        """Should raise ValueError for a cursor that does not decode"""
+        token = ChangeFeed().observe(1, 'list-123', [])
+        for cursor in ('not-a-cursor', encode_cursor('x', token), '%%%'):
+            with self.assertRaises(ValueError):
+                decode_cursor(cursor, token)
+
+
+class TestTokenValidation(unittest.TestCase):
+    """Test cases for rejecting unusable tokens"""
+
+    def setUp(self):
+        self.feed = ChangeFeed(max_log_entries=2)
+        self.token = self.feed.observe(1, 'list-123', [reminder('r1')])
+
+    def test_rejects_missing_and_garbage_tokens(self):
+        self.assertIsNone(self.feed.changes_since(1, 'list-123', None))
+        self.assertIsNone(self.feed.changes_since(1, 'list-123', 'not-a-token'))
+
+    def test_rejects_token_for_other_list(self):
+        """Should not apply one list's token to another list"""
+        self.feed.observe(1, 'list-456', [])
+        self.assertIsNone(self.feed.changes_since(1, 'list-456', self.token))
+
+    def test_rejects_version_never_observed(self):
+        """Should force a resync for a version this process has not seen"""
+        # Arrange
+        other = ChangeFeed()
+        other.observe(1, 'list-123', [reminder('r2')])
+
+        # Act / Assert
+        self.assertIsNone(other.changes_since(1, 'list-123', self.token))
+
+    def test_rejects_token_older_than_log(self):
+        """Should force a resync once the log no longer covers the token"""
+        # Act
+        self.feed.observe(1, 'list-123', [reminder('r1'), reminder('r2')])
+        self.feed.observe(1, 'list-123', [reminder('r2')])
+        self.feed.observe(1, 'list-123', [reminder('r3')])
+
+        # Assert
+        self.assertIsNone(self.feed.changes_since(1, 'list-123', self.token))
+
+    def test_rejects_token_for_other_user(self):
+        self.assertIsNone(self.feed.changes_since(2, 'list-123', self.token))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the decrypted credential cache
+Following TDD approach
+"""
+
+import unittest
+from unittest.mock import patch
+
+from credential_cache import CredentialCache
+
+
+CREDENTIALS = {
+    'apple_id': 'test@icloud.com',
+    'apple_password': 'test_password',
+    'apple_password_encrypted': 'ciphertext'
+}
+
+
+class TestCredentialCache(unittest.TestCase):
+    """Test cases for TTL and invalidation"""
+
+    def test_get_returns_stored_credentials(self):
+        """Should serve credentials stored for a user"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        cache.put(1, CREDENTIALS)
+
+        # Act
+        credentials = cache.get(1)
+
+        # Assert
+        self.assertEqual(credentials, CREDENTIALS)
+        self.assertEqual(cache.stats()['hits'], 1)
+
+    def test_returned_credentials_are_copies(self):
+        """Should not let callers modify the cached entry"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        cache.put(1, CREDENTIALS)
+
+        # Act
+        cache.get(1)['apple_password'] = 'tampered'
+
+        # Assert
+        self.assertEqual(cache.get(1)['apple_password'], 'test_password')
+
+    @patch('credential_cache.time.monotonic')
+    def test_entries_expire_after_ttl(self, mock_monotonic):
+        """Should drop an entry ttl seconds after it was stored, even if used"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        mock_monotonic.return_value = 1000.0
+        cache.put(1, CREDENTIALS)
+        mock_monotonic.return_value = 1299.0
+        cache.get(1)
+
+        # Act
+        mock_monotonic.return_value = 1300.0
+        credentials = cache.get(1)
+
+        # Assert
+        self.assertIsNone(credentials)
+        self.assertEqual(cache.stats()['expirations'], 1)
+
+    def test_invalidate_drops_entry(self):
+        """Should forget a user's credentials when they change"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        cache.put(1, CREDENTIALS)
+
+        # Act
+        cache.invalidate(1)
+
+        # Assert
+        self.assertIsNone(cache.get(1))
+        self.assertEqual(cache.stats()['invalidations'], 1)
+
+    def test_read_racing_invalidate_not_cached(self):
+        """Should not cache credentials read before an update committed"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        generation = cache.generation()
+
+        # Act: the update lands between the reader's query and its put
+        cache.invalidate(1)
+        cache.put(1, CREDENTIALS, generation)
+
+        # Assert
+        self.assertIsNone(cache.get(1))
+
+    def test_read_after_invalidate_cached(self):
+        """Should cache credentials read after the last invalidation"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        cache.invalidate(1)
+        generation = cache.generation()
+
+        # Act
+        cache.put(1, CREDENTIALS, generation)
+
+        # Assert
+        self.assertEqual(cache.get(1), CREDENTIALS)
+
+    def test_invalidating_other_user_keeps_read(self):
+        """Should only skip the put for the user that was invalidated"""
+        # Arrange
+        cache = CredentialCache(ttl=300)
+        generation = cache.generation()
+
+        # Act
+        cache.invalidate(2)
+        cache.put(1, CREDENTIALS, generation)
+
+        # Assert
+        self.assertEqual(cache.get(1), CREDENTIALS)
+
+    def test_forgotten_invalidation_still_blocks_racing_read(self):
+        """Should skip a racing put even after the invalidation record was evicted"""
+        # Arrange
+        cache = CredentialCache(ttl=300, max_size=1)
+        generation = cache.generation()
+
+        # Act
+        cache.invalidate(1)
+        cache.invalidate(2)
+        cache.put(1, CREDENTIALS, generation)
+
+        # Assert
+        self.assertIsNone(cache.get(1))
+
+    def test_evicts_least_recently_used(self):
+        """Should keep at most max_size users"""
+        # Arrange
+        cache = CredentialCache(ttl=300, max_size=2)
+        cache.put(1, CREDENTIALS)
+        cache.put(2, CREDENTIALS)
+        cache.get(1)
+
+        # Act
+        cache.put(3, CREDENTIALS)
+
+        # Assert
+        self.assertIsNotNone(cache.get(1))
+        self.assertIsNone(cache.get(2))
+
+    def test_zero_ttl_disables_cache(self):
+        """Should never store anything when ttl is 0"""
+        # Arrange
+        cache = CredentialCache(ttl=0)
+
+        # Act
+        cache.put(1, CREDENTIALS)
+
+        # Assert
+        self.assertIsNone(cache.get(1))
+
+
+if __name__ == '__main__':
+    unittest.main()
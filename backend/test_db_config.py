@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Unit tests for database connection pooling
+Following TDD approach
+"""
+
+import os
+import tempfile
+import threading
+import unittest
+
+from db_config import ConnectionPool, PoolExhausted, connect_sqlite, execute_prepared
+
+
+class TestConnectionPool(unittest.TestCase):
+    """Test cases for the process-wide connection pool"""
+
+    def setUp(self):
+        fd, self.database_path = tempfile.mkstemp(suffix='.db')
+        os.close(fd)
+        conn = connect_sqlite(self.database_path)
+        conn.execute('''
+            CREATE TABLE users (
+                id INTEGER PRIMARY KEY AUTOINCREMENT,
+                username TEXT UNIQUE NOT NULL,
+                apple_id TEXT NOT NULL,
+                apple_password_encrypted TEXT NOT NULL
+            )
+        ''')
+        conn.execute(
+            'INSERT INTO users (username, apple_id, apple_password_encrypted) VALUES (?, ?, ?)',
+            ('testuser', 'test@icloud.com', 'encrypted')
+        )
+        conn.commit()
+        conn.close()
+        self.connects = 0
+
+    def tearDown(self):
+        os.remove(self.database_path)
+
+    def make_pool(self, **kwargs):
+        def connect():
+            self.connects += 1
+            return connect_sqlite(self.database_path)
+        return ConnectionPool(connect, **kwargs)
+
+    def test_released_connection_is_reused(self):
+        """Should hand the same connection to the next request"""
+        # Arrange
+        pool = self.make_pool(min_size=0)
+        first = pool.acquire()
+        pool.release(first)
+
+        # Act
+        second = pool.acquire()
+
+        # Assert
+        self.assertIs(first, second)
+        self.assertEqual(self.connects, 1)
+        self.assertEqual(pool.stats()['reused'], 1)
+
+    def test_min_size_opened_up_front(self):
+        """Should open min_size connections when the pool is created"""
+        # Act
+        pool = self.make_pool(min_size=2, max_size=4)
+
+        # Assert
+        self.assertEqual(self.connects, 2)
+        self.assertEqual(pool.stats()['idle'], 2)
+
+    def test_exhausted_pool_times_out(self):
+        """Should raise PoolExhausted when max_size connections stay checked out"""
+        # Arrange
+        pool = self.make_pool(min_size=0, max_size=1, timeout=0.01)
+        pool.acquire()
+
+        # Act / Assert
+        with self.assertRaises(PoolExhausted):
+            pool.acquire()
+
+    def test_waiter_gets_released_connection(self):
+        """Should wake a blocked acquire when a connection is released"""
+        # Arrange
+        pool = self.make_pool(min_size=0, max_size=1, timeout=5)
+        held = pool.acquire()
+        acquired = []
+        waiter = threading.Thread(target=lambda: acquired.append(pool.acquire()))
+        waiter.start()
+
+        # Act
+        pool.release(held)
+        waiter.join(5)
+
+        # Assert
+        self.assertEqual(acquired, [held])
+
+    def test_unhealthy_connection_replaced(self):
+        """Should replace an idle connection that fails its health check"""
+        # Arrange
+        pool = self.make_pool(min_size=0, health_check_interval=0)
+        broken = pool.acquire()
+        pool.release(broken)
+        broken.close()
+
+        # Act
+        conn = pool.acquire()
+
+        # Assert
+        self.assertIsNot(conn, broken)
+        self.assertEqual(conn.execute('SELECT 1').fetchone()[0], 1)
+        self.assertEqual(pool.stats()['discarded'], 1)
+        self.assertEqual(pool.stats()['size'], 1)
+
+    def test_release_rolls_back_open_transaction(self):
+        """Should not leak uncommitted writes to the next borrower"""
+        # Arrange
+        pool = self.make_pool(min_size=0)
+        conn = pool.acquire()
+        conn.execute("UPDATE users SET apple_id = 'changed@icloud.com'")
+
+        # Act
+        pool.release(conn)
+        row = pool.acquire().execute('SELECT apple_id FROM users').fetchone()
+
+        # Assert
+        self.assertEqual(row['apple_id'], 'test@icloud.com')
+
+    def test_execute_prepared_returns_named_columns(self):
+        """Should run the prepared credentials query by name"""
+        # Arrange
+        pool = self.make_pool(min_size=1)
+        conn = pool.acquire()
+
+        # Act
+        user = execute_prepared(conn, 'user_credentials', (1,)).fetchone()
+
+        # Assert
+        self.assertEqual(user['apple_id'], 'test@icloud.com')
+        self.assertEqual(user['apple_password_encrypted'], 'encrypted')
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""
+Unit tests for conditional GET and response compression helpers
+Following TDD approach
+"""
+
+import gzip
+import unittest
+import zlib
+
+from http_cache import strong_etag, version_etag, if_none_match, choose_encoding, compress
+
+
+class TestETags(unittest.TestCase):
+    """Test cases for ETag generation and If-None-Match matching"""
+
+    def test_same_body_same_etag(self):
+        """Should give identical bodies the same strong ETag"""
+        # Act
+        first = strong_etag(b'{"lists": []}')
+        second = strong_etag(b'{"lists": []}')
+
+        # Assert
+        self.assertEqual(first, second)
+        self.assertTrue(first.startswith('"') and first.endswith('"'))
+
+    def test_changed_body_changes_etag(self):
+        """Should give a different ETag when the body changes"""
+        # Act / Assert
+        self.assertNotEqual(strong_etag(b'{"lists": []}'), strong_etag(b'{"lists": [1]}'))
+
+    def test_encoded_variant_has_own_etag(self):
+        """Should tag a compressed representation differently from the identity one"""
+        # Act / Assert
+        self.assertNotEqual(strong_etag(b'body'), strong_etag(b'body', 'gzip'))
+
+    def test_if_none_match_accepts_any_variant_of_body(self):
+        """Should match a tag for another coding of the same body"""
+        # Arrange
+        identity = strong_etag(b'body')
+        gzipped = strong_etag(b'body', 'gzip')
+
+        # Act / Assert
+        self.assertTrue(if_none_match(identity, gzipped))
+        self.assertTrue(if_none_match(f'W/{gzipped}', identity))
+        self.assertTrue(if_none_match(f'"other", {gzipped}', gzipped))
+
+    def test_if_none_match_rejects_other_body(self):
+        """Should not match a tag for a different body"""
+        # Act / Assert
+        self.assertFalse(if_none_match(strong_etag(b'old'), strong_etag(b'new')))
+        self.assertFalse(if_none_match(None, strong_etag(b'new')))
+
+    def test_version_etag_depends_on_version_and_variant(self):
+        """Should tag each version and variant differently, and repeat the same tag"""
+        # Act / Assert
+        self.assertEqual(version_etag('v1', 'fields=id'), version_etag('v1', 'fields=id'))
+        self.assertNotEqual(version_etag('v1', 'fields=id'), version_etag('v2', 'fields=id'))
+        self.assertNotEqual(version_etag('v1', 'fields=id'), version_etag('v1', 'fields=title'))
+        self.assertTrue(version_etag('v1').startswith('W/"'))
+
+    def test_if_none_match_accepts_version_etag(self):
+        """Should match a weak version tag echoed back by the client"""
+        # Act / Assert
+        self.assertTrue(if_none_match(version_etag('v1'), version_etag('v1')))
+        self.assertFalse(if_none_match(version_etag('v1'), version_etag('v2')))
+
+    def test_if_none_match_wildcard(self):
+        """Should match any body for *"""
+        # Act / Assert
+        self.assertTrue(if_none_match('*', strong_etag(b'body')))
+
+
+class TestCompression(unittest.TestCase):
+    """Test cases for content-coding negotiation"""
+
+    def test_prefers_gzip(self):
+        """Should pick gzip when both codings are accepted equally"""
+        # Act / Assert
+        self.assertEqual(choose_encoding('deflate, gzip'), 'gzip')
+
+    def test_honours_q_values(self):
+        """Should pick the coding with the higher q-value and skip q=0"""
+        # Act / Assert
+        self.assertEqual(choose_encoding('gzip;q=0.5, deflate'), 'deflate')
+        self.assertIsNone(choose_encoding('gzip;q=0, br'))
+        self.assertEqual(choose_encoding('*'), 'gzip')
+
+    def test_identity_without_header(self):
+        """Should not compress when the client sends no Accept-Encoding"""
+        # Act / Assert
+        self.assertIsNone(choose_encoding(None))
+
+    def test_compress_round_trips(self):
+        """Should produce bodies that decode back to the original"""
+        # Arrange
+        body = b'{"reminders": []}' * 50
+
+        # Act / Assert
+        self.assertEqual(gzip.decompress(compress(body, 'gzip')), body)
+        self.assertEqual(zlib.decompress(compress(body, 'deflate')), body)
+
+    def test_gzip_output_is_stable(self):
+        """Should compress the same body to the same bytes so its ETag holds"""
+        # Act / Assert
+        self.assertEqual(compress(b'body' * 100, 'gzip'), compress(b'body' * 100, 'gzip'))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -7,8 +7,14 @@ Following TDD approach
 
 import unittest
 from unittest.mock import Mock, patch, MagicMock
+import gzip
 import json
-from app import app, init_db
+from pyicloud.exceptions import PyiCloudFailedLoginException
+from app import (
+    app, init_db, reminder_cache, change_feed, background_refresher, get_user_credentials,
+    schedule_refresh, ListNotFound
+)
+from db_config import PoolExhausted
 
 
 class TestIntegratedRemindersFlow(unittest.TestCase):
@@ -22,6 +28,10 @@ class TestIntegratedRemindersFlow(unittest.TestCase):
         self.app_context = self.app.app_context()
         self.app_context.push()
         init_db()
+        reminder_cache.clear()
+        change_feed.clear()
+        # Stale reads revalidate inline unless a test opts in
+        reminder_cache.stale_while_revalidate = 0
 
         # Register a test user
         response = self.client.post('/api/auth/register',
@@ -162,6 +172,584 @@ class TestIntegratedRemindersFlow(unittest.TestCase):
         self.assertTrue(mock_reminder['completed'])
         mock_collection.save.assert_called_once()
 
+    @patch('app.get_icloud_service_for_user')
+    def test_complete_batch_saves_each_collection_once(self, mock_get_service):
+        """Should complete many reminders with one save per collection"""
+        # Arrange
+        groceries = [{'guid': 'reminder-1', 'completed': False},
+                     {'guid': 'reminder-2', 'completed': False}]
+        work = [{'guid': 'reminder-3', 'completed': False}]
+
+        groceries_collection = Mock()
+        groceries_collection.guid = 'list-1'
+        groceries_collection.__iter__ = Mock(return_value=iter(groceries))
+        work_collection = Mock()
+        work_collection.guid = 'list-2'
+        work_collection.__iter__ = Mock(return_value=iter(work))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [groceries_collection, work_collection]
+        mock_get_service.return_value = mock_service
+
+        # Act
+        response = self.client.post('/api/reminders/complete-batch',
+                                    json={'items': [
+                                        {'list_id': 'list-1', 'reminder_id': 'reminder-1'},
+                                        {'list_id': 'list-2', 'reminder_id': 'reminder-3'},
+                                        {'list_id': 'list-1', 'reminder_id': 'reminder-2'},
+                                        {'list_id': 'list-1', 'reminder_id': 'missing'},
+                                        {'list_id': 'list-9', 'reminder_id': 'reminder-4'}
+                                    ]},
+                                    headers={'Authorization': f'Bearer {self.token}'},
+                                    content_type='application/json')
+        data = json.loads(response.data)
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(data['completed'], 3)
+        self.assertFalse(data['success'])
+        self.assertEqual([r['status'] for r in data['results']],
+                         ['completed', 'completed', 'completed', 'not_found', 'not_found'])
+        self.assertTrue(all(r['completed'] for r in groceries + work))
+        groceries_collection.save.assert_called_once()
+        work_collection.save.assert_called_once()
+
+    @patch('app.get_icloud_service_for_user')
+    def test_complete_batch_reports_failed_save(self, mock_get_service):
+        """Should roll back and report items whose collection failed to save"""
+        # Arrange
+        mock_reminder = {'guid': 'reminder-1', 'completed': False}
+        mock_collection = Mock()
+        mock_collection.guid = 'list-1'
+        mock_collection.__iter__ = Mock(return_value=iter([mock_reminder]))
+        mock_collection.save = Mock(side_effect=Exception('iCloud unavailable'))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+
+        # Act
+        response = self.client.post('/api/reminders/complete-batch',
+                                    json={'items': [{'list_id': 'list-1', 'reminder_id': 'reminder-1'}]},
+                                    headers={'Authorization': f'Bearer {self.token}'},
+                                    content_type='application/json')
+        data = json.loads(response.data)
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(data['results'][0]['status'], 'error')
+        self.assertFalse(mock_reminder['completed'])
+
+    @patch('app.get_icloud_service_for_user')
+    def test_complete_batch_reports_duplicate_like_first(self, mock_get_service):
+        """Should not report a repeated item completed when its save was rolled back"""
+        # Arrange
+        mock_reminder = {'guid': 'reminder-1', 'completed': False}
+        mock_collection = Mock()
+        mock_collection.guid = 'list-1'
+        mock_collection.__iter__ = Mock(return_value=iter([mock_reminder]))
+        mock_collection.save = Mock(side_effect=Exception('iCloud unavailable'))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+
+        # Act
+        item = {'list_id': 'list-1', 'reminder_id': 'reminder-1'}
+        response = self.client.post('/api/reminders/complete-batch',
+                                    json={'items': [item, dict(item)]},
+                                    headers={'Authorization': f'Bearer {self.token}'},
+                                    content_type='application/json')
+        data = json.loads(response.data)
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual([r['status'] for r in data['results']], ['error', 'error'])
+        self.assertEqual(data['completed'], 0)
+        self.assertFalse(mock_reminder['completed'])
+        mock_collection.save.assert_called_once()
+
+    def test_complete_batch_requires_items(self):
+        """Should reject a batch without items"""
+        # Act
+        response = self.client.post('/api/reminders/complete-batch',
+                                    json={'items': []},
+                                    headers={'Authorization': f'Bearer {self.token}'},
+                                    content_type='application/json')
+
+        # Assert
+        self.assertEqual(response.status_code, 400)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_repeat_list_read_served_from_cache(self, mock_get_service):
+        """Should serve a repeat read from the cache without calling iCloud"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.title = 'Test List'
+        mock_collection.color = 'blue'
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+
+        # Act
+        first = self.client.get('/api/reminders/lists', headers=headers)
+        second = self.client.get('/api/reminders/lists', headers=headers)
+
+        # Assert
+        self.assertEqual(first.headers['Cache-Status'], 'MISS')
+        self.assertEqual(second.headers['Cache-Status'], 'HIT')
+        self.assertEqual(json.loads(second.data)['lists'][0]['title'], 'Test List')
+        self.assertEqual(mock_get_service.call_count, 1)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_stale_reminders_revalidated_by_ctag(self, mock_get_service):
+        """Should reuse cached reminders when the collection ctag is unchanged"""
+        # Arrange
+        mock_reminder = {'guid': 'reminder-1', 'title': 'Buy groceries', 'completed': False}
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.ctag = 'ctag-1'
+        mock_collection.__iter__ = Mock(return_value=iter([mock_reminder]))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        self.client.get('/api/reminders/list/list-123', headers=headers)
+
+        # Act
+        reminder_cache.max_staleness = -1
+        try:
+            response = self.client.get('/api/reminders/list/list-123', headers=headers)
+        finally:
+            reminder_cache.max_staleness = 30
+        data = json.loads(response.data)
+
+        # Assert
+        self.assertEqual(response.headers['Cache-Status'], 'REVALIDATED')
+        self.assertEqual(data['reminders'][0]['title'], 'Buy groceries')
+        self.assertEqual(mock_collection.__iter__.call_count, 1)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_stale_reminders_served_while_refreshing(self, mock_get_service):
+        """Should answer from the stale copy and refresh it in the background"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(side_effect=[
+            iter([{'guid': 'reminder-1', 'title': 'Buy groceries', 'completed': False}]),
+            iter([{'guid': 'reminder-1', 'title': 'Buy groceries', 'completed': True}])
+        ])
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        self.client.get('/api/reminders/list/list-123', headers=headers)
+
+        # Act
+        reminder_cache.max_staleness = -1
+        reminder_cache.stale_while_revalidate = 300
+        try:
+            response = self.client.get('/api/reminders/list/list-123', headers=headers)
+            background_refresher.wait_idle(timeout=5)
+        finally:
+            reminder_cache.max_staleness = 30
+        data = json.loads(response.data)
+
+        # Assert
+        self.assertEqual(response.headers['Cache-Status'], 'STALE')
+        self.assertFalse(data['reminders'][0]['completed'])
+        refreshed = reminder_cache.get_reminders(1, 'list-123')
+        self.assertTrue(refreshed.data[0]['completed'])
+
+    @patch('app.session_pool')
+    def test_background_refresh_keeps_session_on_data_error(self, mock_pool):
+        """Should keep the pooled session when a refreshed list is gone"""
+        # Act
+        schedule_refresh((1, 'reminders', 'deleted'), Mock(side_effect=ListNotFound('deleted')))
+        background_refresher.wait_idle(timeout=5)
+
+        # Assert
+        mock_pool.invalidate.assert_not_called()
+
+    @patch('app.session_pool')
+    def test_background_refresh_drops_session_on_auth_error(self, mock_pool):
+        """Should drop the pooled session when iCloud rejects it"""
+        # Act
+        schedule_refresh((1, 'lists'), Mock(side_effect=PyiCloudFailedLoginException('expired')))
+        background_refresher.wait_idle(timeout=5)
+
+        # Assert
+        mock_pool.invalidate.assert_called_once_with(1)
+
+    @patch('app.session_pool')
+    @patch('app.get_icloud_service_for_user')
+    def test_foreground_read_keeps_session_on_data_error(self, mock_get_service, mock_pool):
+        """Should keep the pooled session when a request fails for another reason"""
+        # Arrange
+        mock_get_service.side_effect = KeyError('guid')
+
+        # Act
+        response = self.client.get('/api/reminders/lists',
+                                   headers={'Authorization': f'Bearer {self.token}'})
+
+        # Assert
+        self.assertEqual(response.status_code, 500)
+        mock_pool.invalidate.assert_not_called()
+
+    @patch('app.session_pool')
+    @patch('app.get_icloud_service_for_user')
+    def test_foreground_read_drops_session_on_auth_error(self, mock_get_service, mock_pool):
+        """Should drop the pooled session when iCloud rejects it during a request"""
+        # Arrange
+        mock_get_service.side_effect = PyiCloudFailedLoginException('expired')
+
+        # Act
+        response = self.client.get('/api/reminders/lists',
+                                   headers={'Authorization': f'Bearer {self.token}'})
+
+        # Assert
+        self.assertEqual(response.status_code, 500)
+        mock_pool.invalidate.assert_called_once_with(1)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_changes_feed_returns_deltas(self, mock_get_service):
+        """Should return a full reset first, then only what changed"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(side_effect=[
+            iter([{'guid': 'reminder-1', 'title': 'Buy groceries', 'completed': False}]),
+            iter([{'guid': 'reminder-1', 'title': 'Buy groceries', 'completed': True}])
+        ])
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+
+        # Act
+        first = json.loads(self.client.get('/api/reminders/changes?list_id=list-123',
+                                           headers=headers).data)
+        reminder_cache.clear()
+        second = json.loads(self.client.get(
+            f"/api/reminders/changes?list_id=list-123&since={first['token']}",
+            headers=headers).data)
+
+        # Assert
+        self.assertTrue(first['reset'])
+        self.assertEqual(len(first['reminders']), 1)
+        self.assertFalse(second['reset'])
+        self.assertEqual(len(second['changes']), 1)
+        self.assertEqual(second['changes'][0]['type'], 'completed')
+        self.assertNotEqual(second['token'], first['token'])
+
+    @patch('app.get_icloud_service_for_user')
+    def test_unchanged_lists_return_not_modified(self, mock_get_service):
+        """Should answer 304 with no body when the client's ETag still matches"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.title = 'Test List'
+        mock_collection.color = 'blue'
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        first = self.client.get('/api/reminders/lists', headers=headers)
+
+        # Act
+        second = self.client.get('/api/reminders/lists',
+                                 headers=dict(headers, **{'If-None-Match': first.headers['ETag']}))
+
+        # Assert
+        self.assertEqual(first.status_code, 200)
+        self.assertEqual(second.status_code, 304)
+        self.assertEqual(second.data, b'')
+        self.assertEqual(second.headers['ETag'], first.headers['ETag'])
+
+    @patch('app.get_icloud_service_for_user')
+    def test_changed_lists_return_new_etag(self, mock_get_service):
+        """Should send the full body when the lists changed since the client's ETag"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.title = 'Test List'
+        mock_collection.color = 'blue'
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        first = self.client.get('/api/reminders/lists', headers=headers)
+        reminder_cache.clear()
+        mock_collection.title = 'Renamed List'
+
+        # Act
+        second = self.client.get('/api/reminders/lists',
+                                 headers=dict(headers, **{'If-None-Match': first.headers['ETag']}))
+
+        # Assert
+        self.assertEqual(second.status_code, 200)
+        self.assertNotEqual(second.headers['ETag'], first.headers['ETag'])
+        self.assertEqual(json.loads(second.data)['lists'][0]['title'], 'Renamed List')
+
+    @patch('app.get_icloud_service_for_user')
+    def test_reminders_compressed_when_accepted(self, mock_get_service):
+        """Should gzip large reminder responses for clients that accept it"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(return_value=iter([
+            {'guid': f'reminder-{i}', 'title': f'Reminder {i}', 'completed': False}
+            for i in range(50)
+        ]))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+
+        # Act
+        response = self.client.get('/api/reminders/list/list-123',
+                                   headers={'Authorization': f'Bearer {self.token}',
+                                            'Accept-Encoding': 'gzip, deflate'})
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(response.headers['Content-Encoding'], 'gzip')
+        self.assertIn('Accept-Encoding', response.headers['Vary'])
+        data = json.loads(gzip.decompress(response.data))
+        self.assertEqual(len(data['reminders']), 50)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_unchanged_reminders_not_modified_on_other_worker(self, mock_get_service):
+        """Should answer 304 for a reminders ETag after the change feed and cache restart"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(side_effect=lambda: iter([
+            {'guid': 'reminder-1', 'title': 'Task', 'completed': False}
+        ]))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        first = self.client.get('/api/reminders/list/list-123?fields=id,title', headers=headers)
+        # A second worker holds none of this process's state
+        reminder_cache.clear()
+        change_feed.clear()
+
+        # Act
+        second = self.client.get('/api/reminders/list/list-123?fields=id,title',
+                                 headers=dict(headers, **{'If-None-Match': first.headers['ETag']}))
+        other_fields = self.client.get('/api/reminders/list/list-123?fields=id',
+                                       headers=dict(headers, **{'If-None-Match': first.headers['ETag']}))
+
+        # Assert
+        self.assertEqual(first.status_code, 200)
+        self.assertEqual(second.status_code, 304)
+        self.assertEqual(second.data, b'')
+        self.assertEqual(second.headers['ETag'], first.headers['ETag'])
+        self.assertEqual(other_fields.status_code, 200)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_unchanged_changes_short_circuit_before_diff(self, mock_get_service):
+        """Should answer a matching changes ETag with 304 without resolving the delta"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(side_effect=lambda: iter([
+            {'guid': 'reminder-1', 'title': 'Task', 'completed': False}
+        ]))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        first = self.client.get('/api/reminders/changes?list_id=list-123', headers=headers)
+        token = json.loads(first.data)['token']
+
+        # Act
+        with patch.object(change_feed, 'changes_since') as mock_changes_since:
+            second = self.client.get(f'/api/reminders/changes?list_id=list-123&since={token}',
+                                     headers=dict(headers, **{'If-None-Match': first.headers['ETag']}))
+
+        # Assert
+        self.assertEqual(second.status_code, 304)
+        self.assertEqual(second.headers['ETag'], first.headers['ETag'])
+        mock_changes_since.assert_not_called()
+
+    @patch('app.get_icloud_service_for_user')
+    def test_get_reminders_paginated_with_projection(self, mock_get_service):
+        """Should page through reminders with a cursor and return only requested fields"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(return_value=iter([
+            {'guid': f'reminder-{i}', 'title': f'Task {i}', 'completed': False,
+             'description': 'Details', 'priority': 1}
+            for i in range(5)
+        ]))
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+
+        # Act
+        first = json.loads(self.client.get(
+            '/api/reminders/list/list-123?limit=3&fields=id,title,completed',
+            headers=headers).data)
+        second = json.loads(self.client.get(
+            f"/api/reminders/list/list-123?limit=3&fields=id,title,completed&cursor={first['next_cursor']}",
+            headers=headers).data)
+
+        # Assert
+        self.assertEqual(first['total'], 5)
+        self.assertEqual([r['id'] for r in first['reminders']],
+                         ['reminder-0', 'reminder-1', 'reminder-2'])
+        self.assertEqual(set(first['reminders'][0]), {'id', 'title', 'completed'})
+        self.assertEqual([r['id'] for r in second['reminders']], ['reminder-3', 'reminder-4'])
+        self.assertIsNone(second['next_cursor'])
+        self.assertEqual(second['sync_token'], first['sync_token'])
+
+    @patch('app.get_icloud_service_for_user')
+    def test_get_reminders_rejects_bad_pagination(self, mock_get_service):
+        """Should reject unknown fields, bad limits and cursors from an older list"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.__iter__ = Mock(side_effect=[
+            iter([{'guid': 'reminder-1', 'title': 'Buy groceries', 'completed': False},
+                  {'guid': 'reminder-2', 'title': 'Call mom', 'completed': False}]),
+            iter([{'guid': 'reminder-2', 'title': 'Call mom', 'completed': False}])
+        ])
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        first = json.loads(self.client.get('/api/reminders/list/list-123?limit=1',
+                                           headers=headers).data)
+        reminder_cache.clear()
+
+        # Act
+        bad_field = self.client.get('/api/reminders/list/list-123?fields=id,secret',
+                                    headers=headers)
+        bad_limit = self.client.get('/api/reminders/list/list-123?limit=0', headers=headers)
+        stale_cursor = self.client.get(
+            f"/api/reminders/list/list-123?limit=1&cursor={first['next_cursor']}",
+            headers=headers)
+
+        # Assert
+        self.assertEqual(bad_field.status_code, 400)
+        self.assertEqual(bad_limit.status_code, 400)
+        self.assertEqual(stale_cursor.status_code, 409)
+
+    @patch('app.session_pool')
+    @patch('app.get_user_credentials')
+    def test_reminder_read_retried_when_pool_exhausted(self, mock_credentials, mock_pool):
+        """Should answer 503 with Retry-After and keep the session when no connection is free"""
+        # Arrange
+        mock_credentials.side_effect = PoolExhausted('No database connection free within 10s')
+
+        # Act
+        response = self.client.get('/api/reminders/list/list-123',
+                                   headers={'Authorization': f'Bearer {self.token}'})
+
+        # Assert
+        self.assertEqual(response.status_code, 503)
+        self.assertEqual(response.headers['Retry-After'], '1')
+        mock_pool.invalidate.assert_not_called()
+
+    def test_changes_feed_requires_list_id(self):
+        """Should reject change requests without a list_id"""
+        # Act
+        response = self.client.get('/api/reminders/changes',
+                                   headers={'Authorization': f'Bearer {self.token}'})
+
+        # Assert
+        self.assertEqual(response.status_code, 400)
+
+    @patch('app.session_pool')
+    def test_update_credentials_replaces_cached_password(self, mock_pool):
+        """Should serve the new Apple password right after an update"""
+        # Arrange
+        get_user_credentials(1)
+
+        # Act
+        response = self.client.put('/api/auth/credentials',
+                                   json={
+                                       'apple_id': 'new@icloud.com',
+                                       'apple_password': 'new_password'
+                                   },
+                                   headers={'Authorization': f'Bearer {self.token}'})
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+        self.assertEqual(get_user_credentials(1)['apple_password'], 'new_password')
+        mock_pool.invalidate.assert_called_once_with(1)
+
+    @patch('app.get_icloud_service_for_user')
+    def test_update_credentials_drops_cached_reminders(self, mock_get_service):
+        """Should not serve the previous Apple ID's lists after a credential update"""
+        # Arrange
+        mock_collection = Mock()
+        mock_collection.guid = 'list-123'
+        mock_collection.title = 'Test List'
+        mock_collection.color = 'blue'
+
+        mock_service = Mock()
+        mock_service.reminders.collections = [mock_collection]
+        mock_get_service.return_value = mock_service
+        headers = {'Authorization': f'Bearer {self.token}'}
+        self.client.get('/api/reminders/lists', headers=headers)
+
+        # Act
+        self.client.put('/api/auth/credentials',
+                        json={
+                            'apple_id': 'new@icloud.com',
+                            'apple_password': 'new_password'
+                        },
+                        headers=headers)
+        response = self.client.get('/api/reminders/lists', headers=headers)
+
+        # Assert
+        self.assertEqual(response.headers['Cache-Status'], 'MISS')
+        self.assertEqual(mock_get_service.call_count, 2)
+
+    def test_logout_revokes_token(self):
+        """Should reject the token on requests after logout"""
+        # Arrange
+        headers = {'Authorization': f'Bearer {self.token}'}
+
+        # Act
+        logout = self.client.post('/api/auth/logout', headers=headers)
+        response = self.client.get('/api/reminders/lists', headers=headers)
+
+        # Assert
+        self.assertEqual(logout.status_code, 200)
+        self.assertEqual(response.status_code, 401)
+
+    def test_update_credentials_validates_input(self):
+        """Should reject a malformed Apple ID"""
+        # Act
+        response = self.client.put('/api/auth/credentials',
+                                   json={
+                                       'apple_id': 'not-an-email',
+                                       'apple_password': 'new_password'
+                                   },
+                                   headers={'Authorization': f'Bearer {self.token}'})
+
+        # Assert
+        self.assertEqual(response.status_code, 400)
+
 
 class TestMultiUserIsolation(unittest.TestCase):
     """Test that users can only access their own data"""
@@ -174,6 +762,7 @@ class TestMultiUserIsolation(unittest.TestCase):
         self.app_context = self.app.app_context()
         self.app_context.push()
         init_db()
+        reminder_cache.clear()
 
         # Register two users
         response1 = self.client.post('/api/auth/register',
@@ -250,6 +839,17 @@ class TestHealthEndpoint(unittest.TestCase):
         self.assertEqual(data['status'], 'healthy')
         self.assertIn('timestamp', data)
 
+    def test_metrics_reports_session_pool(self):
+        """Should expose session pool counters"""
+        # Act
+        response = self.client.get('/metrics')
+        data = json.loads(response.data)
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+        self.assertIn('sessions', data)
+        self.assertIn('hit_rate', data['sessions'])
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Unit tests for rate limit storage settings
+Following TDD approach
+"""
+
+import unittest
+from unittest.mock import patch
+
+from flask import Flask
+from flask_limiter import Limiter
+from limits.storage import MemoryStorage
+
+from rate_limit import limit_processes, limiter_options, limiter_strategy, per_process_limit
+
+
+class UnreachableStorage(MemoryStorage):
+    """Shared store that is down"""
+
+    def incr(self, *args, **kwargs):
+        raise ConnectionError('store unreachable')
+
+    def get(self, *args, **kwargs):
+        raise ConnectionError('store unreachable')
+
+    def acquire_entry(self, *args, **kwargs):
+        raise ConnectionError('store unreachable')
+
+    def get_moving_window(self, *args, **kwargs):
+        raise ConnectionError('store unreachable')
+
+    def check(self):
+        return False
+
+
+def make_worker(storage_uri, limit):
+    """A Flask app standing in for one worker process"""
+    app = Flask(__name__)
+    limiter = Limiter(
+        app=app,
+        key_func=lambda: 'watch',
+        key_prefix='pebble-icloud',
+        **limiter_options(storage_uri, 'moving-window')
+    )
+
+    @app.route('/login', methods=['POST'])
+    @limiter.limit(limit)
+    def login():
+        return 'ok'
+
+    return app.test_client()
+
+
+class TestLimitSettings(unittest.TestCase):
+    """Test cases for choosing strategy and per-process limits"""
+
+    def test_memcached_uses_fixed_window(self):
+        """Should not ask memcached for a moving window it cannot keep"""
+        # Act / Assert
+        self.assertEqual(limiter_strategy('memcached://localhost:11211', 'moving-window'), 'fixed-window')
+        self.assertEqual(limiter_strategy('redis://localhost:6379', 'moving-window'), 'moving-window')
+
+    def test_limits_split_without_shared_store(self):
+        """Should give each worker its share of a limit when counters are per process"""
+        # Arrange
+        processes = limit_processes('memory://', 4)
+
+        # Act / Assert
+        self.assertEqual(per_process_limit('5 per minute', processes), '2 per minute')
+        self.assertEqual(per_process_limit('200 per day;50/hour', processes), '50 per day;13/hour')
+
+    def test_limits_whole_with_shared_store(self):
+        """Should keep limits whole when every worker counts in one store"""
+        # Act
+        processes = limit_processes('redis://localhost:6379', 4)
+
+        # Assert
+        self.assertEqual(per_process_limit('5 per minute', processes), '5 per minute')
+
+    def test_fallback_only_for_shared_store(self):
+        """Should only fall back to memory when a shared store is configured"""
+        # Act / Assert
+        self.assertTrue(limiter_options('redis://localhost:6379', 'moving-window')['in_memory_fallback_enabled'])
+        self.assertFalse(limiter_options('memory://', 'moving-window')['in_memory_fallback_enabled'])
+
+
+class TestSharedStorage(unittest.TestCase):
+    """Test cases for counting through the configured storage"""
+
+    def test_workers_share_counters(self):
+        """Should count hits on every worker against one limit"""
+        # Arrange
+        shared = MemoryStorage()
+        with patch('flask_limiter.extension.storage_from_string', return_value=shared):
+            first = make_worker('redis://shared:6379', '4 per minute')
+            second = make_worker('redis://shared:6379', '4 per minute')
+
+        # Act
+        statuses = [worker.post('/login').status_code for worker in (first, second, first, second, first)]
+
+        # Assert
+        self.assertEqual(statuses, [200, 200, 200, 200, 429])
+
+    def test_unreachable_store_falls_back_to_memory(self):
+        """Should keep serving with in-memory counters while the store is down"""
+        # Arrange
+        with patch('flask_limiter.extension.storage_from_string', return_value=UnreachableStorage()):
+            worker = make_worker('redis://down:6379', '4 per minute')
+
+        # Act
+        response = worker.post('/login')
+
+        # Assert
+        self.assertEqual(response.status_code, 200)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the per-user reminder cache
+Following TDD approach
+"""
+
+import unittest
+from unittest.mock import Mock, patch
+
+from reminder_cache import (
+    ReminderCache,
+    collection_ctag,
+    CACHE_HIT,
+    CACHE_MISS,
+    CACHE_REVALIDATED
+)
+
+
+class TestReminderCacheFreshness(unittest.TestCase):
+    """Test cases for the staleness bound"""
+
+    @patch('reminder_cache.time.monotonic')
+    def test_entry_fresh_within_staleness_bound(self, mock_monotonic):
+        """Should treat entries as fresh until max_staleness has passed"""
+        # Arrange
+        mock_monotonic.return_value = 100.0
+        cache = ReminderCache(max_staleness=30)
+        cache.store_lists(1, [{'id': 'list-123'}], {'list-123': 'ctag-1'})
+
+        # Act / Assert
+        mock_monotonic.return_value = 130.0
+        self.assertTrue(cache.is_fresh(cache.get_lists(1)))
+        mock_monotonic.return_value = 130.5
+        self.assertFalse(cache.is_fresh(cache.get_lists(1)))
+
+    @patch('reminder_cache.time.monotonic')
+    def test_stale_entry_servable_within_revalidate_window(self, mock_monotonic):
+        """Should allow serving a stale entry only within stale_while_revalidate"""
+        # Arrange
+        mock_monotonic.return_value = 100.0
+        cache = ReminderCache(max_staleness=30, stale_while_revalidate=60)
+        cache.store_reminders(1, 'list-123', [{'id': 'r1'}], 'ctag-1')
+        entry = cache.get_reminders(1, 'list-123')
+
+        # Act / Assert
+        mock_monotonic.return_value = 150.0
+        self.assertFalse(cache.is_fresh(entry))
+        self.assertTrue(cache.is_servable_stale(entry))
+        mock_monotonic.return_value = 190.5
+        self.assertFalse(cache.is_servable_stale(entry))
+        self.assertFalse(ReminderCache(max_staleness=30).is_servable_stale(entry))
+
+    def test_missing_entry_is_not_fresh(self):
+        """Should report a miss for unknown users"""
+        cache = ReminderCache()
+        self.assertFalse(cache.is_fresh(cache.get_reminders(1, 'list-123')))
+
+
+class TestReminderCacheInvalidation(unittest.TestCase):
+    """Test cases for ctag-based and explicit invalidation"""
+
+    def setUp(self):
+        self.cache = ReminderCache()
+        self.cache.store_reminders(1, 'list-a', [{'id': 'r1'}], 'ctag-a')
+        self.cache.store_reminders(1, 'list-b', [{'id': 'r2'}], 'ctag-b')
+
+    def test_lists_refresh_drops_changed_collections(self):
+        """Should drop reminders only for lists whose ctag changed"""
+        # Act
+        self.cache.store_lists(1, [], {'list-a': 'ctag-a', 'list-b': 'ctag-b2'})
+
+        # Assert
+        self.assertIsNotNone(self.cache.get_reminders(1, 'list-a'))
+        self.assertIsNone(self.cache.get_reminders(1, 'list-b'))
+
+    def test_lists_refresh_drops_deleted_collections(self):
+        """Should drop reminders for lists that no longer exist"""
+        # Act
+        self.cache.store_lists(1, [], {'list-a': 'ctag-a'})
+
+        # Assert
+        self.assertIsNone(self.cache.get_reminders(1, 'list-b'))
+
+    def test_invalidate_list(self):
+        """Should forget a list after a local modification"""
+        # Act
+        self.cache.invalidate_list(1, 'list-a')
+
+        # Assert
+        self.assertIsNone(self.cache.get_reminders(1, 'list-a'))
+        self.assertIsNotNone(self.cache.get_reminders(1, 'list-b'))
+
+    def test_users_are_isolated(self):
+        """Should never return another user's reminders"""
+        self.assertIsNone(self.cache.get_reminders(2, 'list-a'))
+
+
+class TestReminderCacheStats(unittest.TestCase):
+    """Test cases for hit-rate accounting"""
+
+    def test_hit_rate_counts_revalidations_as_served(self):
+        """Should count hits and revalidations against misses"""
+        # Arrange
+        cache = ReminderCache()
+
+        # Act
+        cache.record(CACHE_HIT)
+        cache.record(CACHE_REVALIDATED)
+        cache.record(CACHE_MISS)
+        cache.record(CACHE_MISS)
+
+        # Assert
+        stats = cache.stats()
+        self.assertEqual(stats['hits'], 1)
+        self.assertEqual(stats['misses'], 2)
+        self.assertEqual(stats['hit_rate'], 0.5)
+
+    def test_evicts_least_recently_used_user(self):
+        """Should cap the number of cached users"""
+        # Arrange
+        cache = ReminderCache(max_users=2)
+
+        # Act
+        cache.store_reminders(1, 'list-a', [], None)
+        cache.store_reminders(2, 'list-a', [], None)
+        cache.store_reminders(3, 'list-a', [], None)
+
+        # Assert
+        self.assertIsNone(cache.get_reminders(1, 'list-a'))
+        self.assertEqual(cache.stats()['users'], 2)
+
+
+class TestCollectionCtag(unittest.TestCase):
+    """Test cases for reading ctags off collections"""
+
+    def test_reads_string_ctag(self):
+        collection = Mock()
+        collection.ctag = 'ctag-1'
+        self.assertEqual(collection_ctag(collection), 'ctag-1')
+
+    def test_ignores_missing_ctag(self):
+        """Should return None rather than an arbitrary attribute value"""
+        self.assertIsNone(collection_ctag(Mock()))
+        self.assertIsNone(collection_ctag(object()))
+
+
+if __name__ == '__main__':
+    unittest.main()
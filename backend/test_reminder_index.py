@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the per-session collection/reminder index
+Following TDD approach
+"""
+
+import unittest
+from unittest.mock import Mock
+
+from reminder_index import ReminderIndex, ReminderIndexRegistry
+
+
+def make_collection(guid, reminders, ctag=None):
+    collection = Mock()
+    collection.guid = guid
+    collection.ctag = ctag
+    collection.__iter__ = Mock(side_effect=lambda: iter(list(reminders)))
+    return collection
+
+
+def make_service(collections):
+    service = Mock()
+    service.reminders.collections = collections
+    return service
+
+
+class TestCollectionLookup(unittest.TestCase):
+    """Test cases for guid -> collection lookup"""
+
+    def test_finds_collection_by_guid(self):
+        # Arrange
+        work = make_collection('list-work', [])
+        home = make_collection('list-home', [])
+        index = ReminderIndex(make_service([work, home]))
+
+        # Act / Assert
+        self.assertIs(index.collection('list-home'), home)
+        self.assertIs(index.collection('list-work'), work)
+        self.assertIsNone(index.collection('missing'))
+
+    def test_picks_up_refreshed_collections(self):
+        """Should rebuild when the service's collections are replaced"""
+        # Arrange
+        service = make_service([make_collection('list-a', [])])
+        index = ReminderIndex(service)
+        index.collection('list-a')
+
+        # Act
+        replacement = make_collection('list-a', [])
+        service.reminders.collections = [replacement]
+
+        # Assert
+        self.assertIs(index.collection('list-a'), replacement)
+
+
+class TestReminderLookup(unittest.TestCase):
+    """Test cases for guid -> reminder lookup"""
+
+    def setUp(self):
+        self.items = [{'guid': f'reminder-{i}', 'completed': False} for i in range(2000)]
+        self.collection = make_collection('list-123', self.items, ctag='ctag-1')
+        self.index = ReminderIndex(make_service([self.collection]))
+
+    def test_lookup_does_not_rescan_unchanged_collection(self):
+        """Should iterate the collection once for repeated lookups"""
+        # Act
+        first = self.index.reminder(self.collection, 'reminder-1999')
+        second = self.index.reminder(self.collection, 'reminder-5')
+
+        # Assert
+        self.assertIs(first, self.items[1999])
+        self.assertIs(second, self.items[5])
+        self.assertEqual(self.collection.__iter__.call_count, 1)
+
+    def test_ctag_change_rebuilds_map(self):
+        """Should rescan after the collection ctag moves"""
+        # Arrange
+        self.index.reminders(self.collection)
+
+        # Act
+        self.collection.ctag = 'ctag-2'
+        self.index.reminder(self.collection, 'reminder-1')
+
+        # Assert
+        self.assertEqual(self.collection.__iter__.call_count, 2)
+
+    def test_unknown_guid_triggers_one_rescan(self):
+        """Should rescan once for a reminder added since the map was built"""
+        # Arrange
+        self.index.reminders(self.collection)
+        self.items.append({'guid': 'reminder-new', 'completed': False})
+
+        # Act
+        found = self.index.reminder(self.collection, 'reminder-new')
+
+        # Assert
+        self.assertIsNotNone(found)
+        self.assertEqual(self.collection.__iter__.call_count, 2)
+
+    def test_collection_without_ctag_is_reread(self):
+        """Should always re-read collections that have no ctag"""
+        # Arrange
+        collection = make_collection('list-456', [{'guid': 'r1'}])
+        index = ReminderIndex(make_service([collection]))
+
+        # Act
+        index.reminders(collection)
+        index.reminders(collection)
+
+        # Assert
+        self.assertEqual(collection.__iter__.call_count, 2)
+
+
+class TestIndexRegistry(unittest.TestCase):
+    """Test cases for per-user index reuse"""
+
+    def test_reuses_index_for_same_session(self):
+        registry = ReminderIndexRegistry()
+        service = make_service([])
+        self.assertIs(registry.get(1, service), registry.get(1, service))
+
+    def test_new_session_gets_new_index(self):
+        """Should not reuse an index built from an old session"""
+        registry = ReminderIndexRegistry()
+        first = registry.get(1, make_service([]))
+        self.assertIsNot(first, registry.get(1, make_service([])))
+
+    def test_forget_drops_users_index(self):
+        """Should build a new index for a user after forgetting theirs"""
+        registry = ReminderIndexRegistry()
+        service = make_service([])
+        first = registry.get(1, service)
+        registry.forget(1)
+        self.assertIsNot(first, registry.get(1, service))
+
+
+if __name__ == '__main__':
+    unittest.main()
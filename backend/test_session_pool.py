@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the per-user iCloud session pool
+Following TDD approach
+"""
+
+import shutil
+import tempfile
+import threading
+import time
+import unittest
+from unittest.mock import Mock, patch
+
+from session_pool import ICloudSessionPool
+
+
+class TestSessionReuse(unittest.TestCase):
+    """Test cases for reusing pooled sessions"""
+
+    def setUp(self):
+        self.factory = Mock(side_effect=lambda *args: Mock())
+        self.pool = ICloudSessionPool(self.factory, max_size=2, idle_ttl=60)
+
+    def test_reuses_session_for_same_user(self):
+        """Should log in once and reuse the session afterwards"""
+        # Act
+        first = self.pool.get(1, 'a@icloud.com', 'password')
+        second = self.pool.get(1, 'a@icloud.com', 'password')
+
+        # Assert
+        self.assertIs(first, second)
+        self.assertEqual(self.factory.call_count, 1)
+        stats = self.pool.stats()
+        self.assertEqual(stats['hits'], 1)
+        self.assertEqual(stats['misses'], 1)
+        self.assertEqual(stats['size'], 1)
+
+    def test_password_change_forces_new_login(self):
+        """Should not reuse a session created with old credentials"""
+        # Act
+        first = self.pool.get(1, 'a@icloud.com', 'old_password')
+        second = self.pool.get(1, 'a@icloud.com', 'new_password')
+
+        # Assert
+        self.assertIsNot(first, second)
+        self.assertEqual(self.factory.call_count, 2)
+
+    def test_invalidate_drops_session(self):
+        """Should log in again after invalidation"""
+        # Arrange
+        self.pool.get(1, 'a@icloud.com', 'password')
+
+        # Act
+        self.pool.invalidate(1)
+        self.pool.get(1, 'a@icloud.com', 'password')
+
+        # Assert
+        self.assertEqual(self.factory.call_count, 2)
+        self.assertEqual(self.pool.stats()['invalidations'], 1)
+
+    def test_failed_login_is_not_pooled(self):
+        """Should propagate login errors without caching them"""
+        # Arrange
+        self.factory.side_effect = Exception("iCloud login failed")
+
+        # Act / Assert
+        with self.assertRaises(Exception):
+            self.pool.get(1, 'a@icloud.com', 'password')
+        self.assertEqual(self.pool.stats()['size'], 0)
+        self.assertEqual(self.pool.stats()['login_failures'], 1)
+
+
+class TestSessionEviction(unittest.TestCase):
+    """Test cases for LRU eviction and idle expiry"""
+
+    def test_evicts_least_recently_used(self):
+        """Should evict the least recently used user when full"""
+        # Arrange
+        factory = Mock(side_effect=lambda *args: Mock())
+        pool = ICloudSessionPool(factory, max_size=2, idle_ttl=60)
+        pool.get(1, 'a@icloud.com', 'password')
+        pool.get(2, 'b@icloud.com', 'password')
+        pool.get(1, 'a@icloud.com', 'password')
+
+        # Act
+        pool.get(3, 'c@icloud.com', 'password')
+        pool.get(1, 'a@icloud.com', 'password')
+        pool.get(2, 'b@icloud.com', 'password')
+
+        # Assert
+        self.assertEqual(factory.call_count, 4)
+        self.assertEqual(pool.stats()['evictions'], 2)
+
+    @patch('session_pool.time.monotonic')
+    def test_expires_idle_sessions(self, mock_monotonic):
+        """Should log in again after the idle TTL has passed"""
+        # Arrange
+        mock_monotonic.return_value = 1000.0
+        factory = Mock(side_effect=lambda *args: Mock())
+        pool = ICloudSessionPool(factory, max_size=2, idle_ttl=60)
+        pool.get(1, 'a@icloud.com', 'password')
+
+        # Act
+        mock_monotonic.return_value = 1061.0
+        pool.get(1, 'a@icloud.com', 'password')
+
+        # Assert
+        self.assertEqual(factory.call_count, 2)
+        self.assertEqual(pool.stats()['expirations'], 1)
+
+
+class TestSessionConcurrency(unittest.TestCase):
+    """Test cases for concurrent access"""
+
+    def test_concurrent_requests_share_one_login(self):
+        """Should perform a single login for concurrent requests"""
+        # Arrange
+        def slow_login(*args):
+            time.sleep(0.05)
+            return Mock()
+
+        factory = Mock(side_effect=slow_login)
+        pool = ICloudSessionPool(factory, max_size=10, idle_ttl=60)
+        results = []
+
+        def worker():
+            results.append(pool.get(1, 'a@icloud.com', 'password'))
+
+        # Act
+        threads = [threading.Thread(target=worker) for _ in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        # Assert
+        self.assertEqual(factory.call_count, 1)
+        self.assertEqual(len(set(id(service) for service in results)), 1)
+
+    def test_login_locks_are_not_kept(self):
+        """Should not keep a per-user lock once no login is running"""
+        # Arrange
+        pool = ICloudSessionPool(Mock(side_effect=lambda *args: Mock()), max_size=1, idle_ttl=60)
+
+        # Act
+        for user_id in range(50):
+            pool.get(user_id, f'{user_id}@icloud.com', 'password')
+
+        # Assert
+        self.assertEqual(len(pool._user_locks), 0)
+
+
+class TestCookieDirectories(unittest.TestCase):
+    """Test cases for per-user pyicloud cookie directories"""
+
+    def setUp(self):
+        self.cookie_root = tempfile.mkdtemp()
+
+    def tearDown(self):
+        shutil.rmtree(self.cookie_root)
+
+    def test_passes_per_user_cookie_directory(self):
+        """Should give each user their own cookie directory"""
+        # Arrange
+        factory = Mock(return_value=Mock())
+        pool = ICloudSessionPool(factory, cookie_root=self.cookie_root)
+
+        # Act
+        pool.get(42, 'a@icloud.com', 'password')
+
+        # Assert
+        cookie_directory = factory.call_args[0][2]
+        self.assertTrue(cookie_directory.endswith('42'))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""
+Unit tests for single-flight call coalescing
+Following TDD approach
+"""
+
+import threading
+import time
+import unittest
+from unittest.mock import Mock
+
+from singleflight import Group
+
+
+class TestSingleFlight(unittest.TestCase):
+    """Test cases for sharing in-flight calls"""
+
+    def setUp(self):
+        self.group = Group()
+
+    def run_concurrently(self, key, fn, callers):
+        """Start callers threads on key once fn is in flight; return their results"""
+        results = [None] * callers
+        errors = [None] * callers
+
+        def call(i):
+            try:
+                results[i] = self.group.do(key, fn)
+            except BaseException as e:
+                errors[i] = e
+
+        threads = [threading.Thread(target=call, args=(i,)) for i in range(callers)]
+        threads[0].start()
+        while not self.group.in_flight(key):
+            time.sleep(0.001)
+        for thread in threads[1:]:
+            thread.start()
+        # Let the followers join the call before the leader finishes
+        while self.group.stats()['shared'] < callers - 1:
+            time.sleep(0.001)
+        return threads, results, errors
+
+    def test_concurrent_callers_share_one_call(self):
+        """Should run fn once and hand its result to every concurrent caller"""
+        # Arrange
+        release = threading.Event()
+        fn = Mock(side_effect=lambda: release.wait(5) and ['reminder-1'])
+
+        # Act
+        threads, results, errors = self.run_concurrently((1, 'reminders', 'list-123'), fn, 4)
+        release.set()
+        for thread in threads:
+            thread.join(5)
+
+        # Assert
+        self.assertEqual(fn.call_count, 1)
+        self.assertEqual(results, [['reminder-1']] * 4)
+        self.assertEqual(self.group.stats()['shared'], 3)
+
+    def test_error_raised_in_every_caller(self):
+        """Should raise the leader's exception in callers that shared the call"""
+        # Arrange
+        release = threading.Event()
+
+        def fail():
+            release.wait(5)
+            raise ValueError('iCloud unavailable')
+
+        # Act
+        threads, results, errors = self.run_concurrently((1, 'lists'), fail, 3)
+        release.set()
+        for thread in threads:
+            thread.join(5)
+
+        # Assert
+        self.assertTrue(all(isinstance(error, ValueError) for error in errors))
+
+    def test_base_exception_raised_in_every_caller(self):
+        """Should hand a BaseException such as a gevent Timeout to every caller"""
+        # Arrange
+        class Timeout(BaseException):
+            pass
+
+        release = threading.Event()
+
+        def time_out():
+            release.wait(5)
+            raise Timeout()
+
+        # Act
+        threads, results, errors = self.run_concurrently((1, 'lists'), time_out, 3)
+        release.set()
+        for thread in threads:
+            thread.join(5)
+
+        # Assert
+        self.assertTrue(all(isinstance(error, Timeout) for error in errors))
+        self.assertFalse(self.group.in_flight((1, 'lists')))
+
+    def test_sequential_calls_are_not_coalesced(self):
+        """Should start a new call once the previous one has returned"""
+        # Arrange
+        fn = Mock(side_effect=[1, 2])
+
+        # Act
+        first = self.group.do((1, 'lists'), fn)
+        second = self.group.do((1, 'lists'), fn)
+
+        # Assert
+        self.assertEqual((first, second), (1, 2))
+        self.assertFalse(self.group.in_flight((1, 'lists')))
+
+    def test_different_keys_run_separately(self):
+        """Should not share calls across users or lists"""
+        # Arrange
+        fn = Mock(return_value='ok')
+
+        # Act
+        self.group.do((1, 'reminders', 'list-a'), fn)
+        self.group.do((1, 'reminders', 'list-b'), fn)
+        self.group.do((2, 'reminders', 'list-a'), fn)
+
+        # Assert
+        self.assertEqual(fn.call_count, 3)
+
+
+if __name__ == '__main__':
+    unittest.main()
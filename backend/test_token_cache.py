@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Unit tests for the verified JWT cache
+Following TDD approach
+"""
+
+import time
+import unittest
+from unittest.mock import patch
+
+from token_cache import VerifiedTokenCache, token_hash
+
+
+class TestVerifiedTokenCache(unittest.TestCase):
+    """Test cases for caching verified tokens"""
+
+    def setUp(self):
+        self.cache = VerifiedTokenCache(max_size=2, max_age=60)
+        self.exp = int(time.time()) + 3600
+
+    def test_verified_token_served_from_cache(self):
+        """Should return the user_id of a token verified earlier"""
+        # Arrange
+        self.cache.put('token-a', 1, self.exp)
+
+        # Act
+        user_id = self.cache.get('token-a')
+
+        # Assert
+        self.assertEqual(user_id, 1)
+        self.assertEqual(self.cache.stats()['hits'], 1)
+
+    def test_keyed_by_hash(self):
+        """Should not keep raw bearer tokens"""
+        # Arrange
+        self.cache.put('token-a', 1, self.exp)
+
+        # Assert
+        self.assertEqual(list(self.cache._entries), [token_hash('token-a')])
+
+    @patch('token_cache.time.time')
+    def test_entry_expires_at_token_exp(self, mock_time):
+        """Should stop serving a token once it expires"""
+        # Arrange
+        mock_time.return_value = 1000.0
+        self.cache.put('token-a', 1, 1030)
+
+        # Act
+        mock_time.return_value = 1030.0
+        user_id = self.cache.get('token-a')
+
+        # Assert
+        self.assertIsNone(user_id)
+
+    @patch('token_cache.time.time')
+    def test_entry_expires_after_max_age(self, mock_time):
+        """Should re-verify a long-lived token after max_age"""
+        # Arrange
+        mock_time.return_value = 1000.0
+        self.cache.put('token-a', 1, 1000 + 86400)
+
+        # Act
+        mock_time.return_value = 1060.0
+        user_id = self.cache.get('token-a')
+
+        # Assert
+        self.assertIsNone(user_id)
+
+    def test_revoked_token_dropped(self):
+        """Should forget a token as soon as it is revoked"""
+        # Arrange
+        self.cache.put('token-a', 1, self.exp)
+
+        # Act
+        self.cache.revoke('token-a', self.exp)
+
+        # Assert
+        self.assertIsNone(self.cache.get('token-a'))
+
+    def test_revoked_token_not_cached_again(self):
+        """Should ignore a put from a verification that raced the revocation"""
+        # Arrange
+        self.cache.revoke('token-a', self.exp)
+
+        # Act
+        self.cache.put('token-a', 1, self.exp)
+
+        # Assert
+        self.assertIsNone(self.cache.get('token-a'))
+
+    def test_bounded_size(self):
+        """Should evict the least recently used token"""
+        # Arrange
+        self.cache.put('token-a', 1, self.exp)
+        self.cache.put('token-b', 2, self.exp)
+        self.cache.get('token-a')
+
+        # Act
+        self.cache.put('token-c', 3, self.exp)
+
+        # Assert
+        self.assertEqual(self.cache.get('token-a'), 1)
+        self.assertIsNone(self.cache.get('token-b'))
+
+
+if __name__ == '__main__':
+    unittest.main()
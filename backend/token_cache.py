@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""
+Verified JWT cache
+Remembers tokens whose signature already checked out so repeat requests
+from the same watch skip HS256 verification
+"""
+
+import hashlib
+import threading
+import time
+from collections import OrderedDict
+
+
+def token_hash(token):
+    """Key tokens by digest so the cache and revocation list never hold bearer tokens"""
+    return hashlib.sha256(token.encode()).hexdigest()
+
+
+class VerifiedTokenCache:
+    """
+    Thread-safe LRU of token hash -> user_id.
+
+    An entry expires at the token's own exp, or max_age seconds after it
+    was verified if that comes first. max_age bounds how long a token
+    revoked in another worker process stays accepted here. Tokens revoked
+    in this process are never cached again, even by a verification that
+    was already in flight.
+    """
+
+    def __init__(self, max_size=10000, max_age=60):
+        self.max_size = max_size
+        self.max_age = max_age
+        self._entries = OrderedDict()
+        self._revoked = {}
+        self._lock = threading.Lock()
+        self._stats = {
+            'hits': 0,
+            'misses': 0,
+            'revocations': 0,
+        }
+
+    def get(self, token):
+        """Return the user_id of a recently verified token, or None"""
+        key = token_hash(token)
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is not None and time.time() >= entry[1]:
+                del self._entries[key]
+                entry = None
+            if entry is None:
+                self._stats['misses'] += 1
+                return None
+            self._entries.move_to_end(key)
+            self._stats['hits'] += 1
+            return entry[0]
+
+    def put(self, token, user_id, exp):
+        if self.max_age <= 0:
+            return
+        key = token_hash(token)
+        expires_at = min(exp, time.time() + self.max_age)
+        with self._lock:
+            if key in self._revoked:
+                return
+            self._entries[key] = (user_id, expires_at)
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_size:
+                self._entries.popitem(last=False)
+
+    def revoke(self, token, exp):
+        key = token_hash(token)
+        now = time.time()
+        with self._lock:
+            self._entries.pop(key, None)
+            self._revoked = {k: e for k, e in self._revoked.items() if e > now}
+            self._revoked[key] = exp
+            self._stats['revocations'] += 1
+
+    def clear(self):
+        with self._lock:
+            self._entries.clear()
+            self._revoked.clear()
+
+    def stats(self):
+        with self._lock:
+            stats = dict(self._stats)
+            stats['size'] = len(self._entries)
+            stats['max_age'] = self.max_age
+            return stats
@@ -16,31 +16,75 @@
 #define KEY_STATUS 12
 #define KEY_ERROR 13
 #define KEY_COUNT 14
+#define KEY_BATCH_START 15
+#define KEY_BATCH 16
+#define KEY_SYNC_TOKEN 17
+#define KEY_HANDLE_EPOCH 18
 
 // Commands
 #define CMD_LOGIN 1
 #define CMD_GET_LISTS 2
 #define CMD_GET_REMINDERS 3
 #define CMD_COMPLETE_REMINDER 4
+#define CMD_GET_REMINDER_PAGE 5
+#define CMD_PREFETCH_REMINDERS 6
 
 // Status codes
 #define STATUS_SUCCESS 1
 #define STATUS_ERROR 0
 
+// KEY_ACTION on a failed CMD_COMPLETE_REMINDER: keep it queued and retry
+#define ACTION_RETRY 1
+
+// First byte of every KEY_BATCH; see Batch decoding
+#define BATCH_VERSION 2
+
 // Maximum counts
-#define MAX_LISTS 20
-#define MAX_REMINDERS 50
+// MAX_REMINDERS bounds the resident window of a reminders list, not the
+// list itself; rows outside the window are paged in from the phone
+#define MAX_LISTS 32
+#define MAX_REMINDERS 400
+
+// Reminder paging
+#define PAGE_ROWS 20
+#define PREFETCH_MARGIN 5
+
+// String arenas
+// Row strings live NUL-terminated in a fixed buffer and rows refer to them
+// by offset, so short titles do not pay for the longest possible one.
+// Rows are capped by whichever runs out first, MAX_* or arena space.
+#if defined(PBL_PLATFORM_APLITE)
+#define LIST_ARENA_SIZE 1536
+#define REMINDER_ARENA_SIZE 8192
+#else
+#define LIST_ARENA_SIZE 4096
+#define REMINDER_ARENA_SIZE 24576
+#endif
+
+typedef uint16_t StrRef;
+#define STR_NONE 0xFFFF
+
+typedef struct {
+  char *data;
+  uint16_t size;
+  uint16_t used;
+} StringArena;
+
+// Lists and reminders are named by uint16 handles the phone assigns in
+// place of their GUIDs. Handles only hold within one handle epoch.
+typedef uint16_t Handle;
+#define HANDLE_NONE 0
 
 // Data structures
 typedef struct {
-  char id[64];
-  char title[64];
+  Handle handle;
+  StrRef title;
 } ReminderList;
 
+// Every row belongs to s_rows_list, so no per-row list handle is kept
 typedef struct {
-  char id[64];
-  char title[128];
-  char list_id[64];
+  Handle handle;
+  StrRef title;
   bool completed;
 } Reminder;
 
@@ -59,9 +103,32 @@ static ReminderList s_lists[MAX_LISTS];
 static int s_list_count = 0;
 static Reminder s_reminders[MAX_REMINDERS];
 static int s_reminder_count = 0;
+
+// s_reminders[0] is row s_window_start of a list with s_reminder_total rows
+static int s_reminder_total = 0;
+static int s_window_start = 0;
+
+// Rows [start, end) have been requested from the phone
+static int s_page_pending_start = -1;
+static int s_page_pending_end = -1;
+
+static char s_list_arena_data[LIST_ARENA_SIZE];
+static char s_reminder_arena_data[REMINDER_ARENA_SIZE];
+static StringArena s_list_arena = { s_list_arena_data, LIST_ARENA_SIZE, 0 };
+static StringArena s_reminder_arena = { s_reminder_arena_data, REMINDER_ARENA_SIZE, 0 };
 static int s_current_list_index = -1;
 static int s_current_reminder_index = -1;
 
+// Which list s_reminders holds, and the sync token those rows match
+static Handle s_rows_list = HANDLE_NONE;
+static char s_sync_token[64] = "";
+
+// Epoch the held handles were issued in; 0 until the phone names one
+static uint16_t s_handle_epoch = 0;
+
+// Set when a row could not be stored at all; the token no longer applies
+static bool s_rows_truncated = false;
+
 // Settings state
 static TextLayer *s_settings_text_layer;
 static char s_username[64] = "";
@@ -72,8 +139,13 @@ static bool s_is_logged_in = false;
 // Forward declarations
 static void send_login_request(void);
 static void send_get_lists_request(void);
-static void send_get_reminders_request(const char *list_id);
-static void send_complete_reminder_request(const char *list_id, const char *reminder_id);
+static void send_get_reminders_request(Handle list);
+static bool send_complete_reminder_request(Handle list, Handle reminder, uint16_t epoch);
+static void send_get_reminder_page_request(int row);
+static bool has_deferred_request(void);
+static void send_prefetch_request(Handle list);
+static void clear_rows(void);
+static void clear_prefetched_lists(void);
 static void show_settings_window(void);
 static void show_reminders_window(void);
 static void show_detail_window(int reminder_index);
@@ -114,6 +186,962 @@ static void save_settings(void) {
   // They are only held in memory during the login flow
 }
 
+// String arena
+
+static const char *arena_get(const StringArena *arena, StrRef ref) {
+  return ref == STR_NONE ? "" : &arena->data[ref];
+}
+
+// Copy len bytes into the arena; returns STR_NONE when it is full
+static StrRef arena_store(StringArena *arena, const uint8_t *str, uint16_t len) {
+  if (arena->used + len + 1 > arena->size) {
+    return STR_NONE;
+  }
+  StrRef ref = arena->used;
+  memcpy(&arena->data[ref], str, len);
+  arena->data[ref + len] = '\0';
+  arena->used += len + 1;
+  return ref;
+}
+
+static void arena_reset(StringArena *arena) {
+  arena->used = 0;
+}
+
+// Slide the strings still referenced by refs down over the ones that are
+// not. Strings are walked in arena order so each move only goes backwards.
+static void arena_compact(StringArena *arena, StrRef *const *refs, int ref_count) {
+  uint16_t read = 0;
+  uint16_t write = 0;
+  while (read < arena->used) {
+    uint16_t len = strlen(&arena->data[read]) + 1;
+    bool live = false;
+    for (int i = 0; i < ref_count; i++) {
+      if (*refs[i] == read) {
+        *refs[i] = write;
+        live = true;
+      }
+    }
+    if (live) {
+      if (write != read) {
+        memmove(&arena->data[write], &arena->data[read], len);
+      }
+      write += len;
+    }
+    read += len;
+  }
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Compacted arena %d -> %d bytes", arena->used, write);
+  arena->used = write;
+}
+
+// Compact the reminder arena down to the titles of the current rows
+static void compact_reminder_arena(void) {
+  int ref_count = s_reminder_count;
+  StrRef **refs = malloc(ref_count * sizeof(StrRef *));
+  if (!refs) {
+    return;
+  }
+  for (int i = 0; i < s_reminder_count; i++) {
+    refs[i] = &s_reminders[i].title;
+  }
+  arena_compact(&s_reminder_arena, refs, ref_count);
+  free(refs);
+}
+
+// Forget the held reminder rows and their strings
+static void clear_rows(void) {
+  s_reminder_count = 0;
+  s_reminder_total = 0;
+  s_window_start = 0;
+  s_page_pending_start = -1;
+  s_page_pending_end = -1;
+  s_rows_list = HANDLE_NONE;
+  s_sync_token[0] = '\0';
+  s_rows_truncated = false;
+  arena_reset(&s_reminder_arena);
+}
+
+// Batch decoding
+// A batch is [version][item count][start row][list handle][item]...
+// where numbers after the count are unsigned LEB128 varints and the list
+// handle is HANDLE_NONE in list batches. Items are
+// Lists:     [handle][title length][title]
+// Reminders: [handle][title length << 1 | completed][title]
+
+typedef struct {
+  int count;
+  int start;
+  Handle list;
+} BatchHeader;
+
+// Read an unsigned LEB128 varint of up to 32 bits
+static bool read_varint(const uint8_t *data, uint16_t length, uint16_t *offset, uint32_t *out) {
+  uint32_t value = 0;
+  for (int shift = 0; shift < 32; shift += 7) {
+    if (*offset >= length) {
+      return false;
+    }
+    uint8_t byte = data[(*offset)++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      *out = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Parse a batch header; *offset is left at the first item
+static bool read_batch_header(const uint8_t *data, uint16_t length, uint16_t *offset, BatchHeader *header) {
+  if (length < 2 || data[0] != BATCH_VERSION) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Unsupported batch version %d", length > 0 ? data[0] : -1);
+    return false;
+  }
+  uint32_t start;
+  uint32_t list;
+  *offset = 2;
+  if (!read_varint(data, length, offset, &start) || !read_varint(data, length, offset, &list) ||
+      start > UINT16_MAX || list > UINT16_MAX) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "Truncated batch header");
+    return false;
+  }
+  header->count = data[1];
+  header->start = start;
+  header->list = list;
+  return true;
+}
+
+// Copy a length-prefixed string out of a batch, truncating to fit out
+static bool read_batch_string(const uint8_t *data, uint16_t length, uint16_t *offset,
+                              char *out, size_t out_size) {
+  if (*offset >= length) {
+    return false;
+  }
+  uint8_t str_len = data[(*offset)++];
+  if (*offset + str_len > length) {
+    return false;
+  }
+  size_t copy_len = str_len < out_size - 1 ? str_len : out_size - 1;
+  memcpy(out, &data[*offset], copy_len);
+  out[copy_len] = '\0';
+  *offset += str_len;
+  return true;
+}
+
+// Store a title of title_len bytes in an arena without copying it
+// anywhere else first
+static bool read_batch_title(const uint8_t *data, uint16_t length, uint16_t *offset,
+                             uint32_t title_len, StringArena *arena, StrRef *out) {
+  if (title_len > (uint32_t)(length - *offset)) {
+    return false;
+  }
+  *out = arena_store(arena, &data[*offset], title_len);
+  *offset += title_len;
+  return true;
+}
+
+// Apply count list items found at offset to rows from start; returns the
+// offset after the last item read. Lists are always resent in full, so
+// the arena is reset with row 0.
+static uint16_t apply_list_batch(int start, int count, const uint8_t *data, uint16_t length,
+                                 uint16_t offset) {
+  if (start == 0) {
+    arena_reset(&s_list_arena);
+  }
+
+  for (int i = 0; i < count; i++) {
+    int index = start + i;
+    if (index < 0 || index >= s_list_count) {
+      break;
+    }
+    ReminderList *list = &s_lists[index];
+    uint32_t handle;
+    uint32_t title_len;
+    if (!read_varint(data, length, &offset, &handle) ||
+        !read_varint(data, length, &offset, &title_len) ||
+        !read_batch_title(data, length, &offset, title_len, &s_list_arena, &list->title)) {
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Truncated list batch at %d", index);
+      break;
+    }
+    list->handle = handle;
+    if (list->title == STR_NONE) {
+      APP_LOG(APP_LOG_LEVEL_WARNING, "List arena full, keeping %d lists", index);
+      s_list_count = index;
+      break;
+    }
+  }
+  return offset;
+}
+
+// Resident window
+
+// Return the resident row for a list row, or NULL if it is paged out
+static Reminder *resident_reminder(int row) {
+  int slot = row - s_window_start;
+  if (slot < 0 || slot >= s_reminder_count) {
+    return NULL;
+  }
+  return &s_reminders[slot];
+}
+
+static void drop_front_rows(int count) {
+  memmove(&s_reminders[0], &s_reminders[count], (s_reminder_count - count) * sizeof(Reminder));
+  s_reminder_count -= count;
+  s_window_start += count;
+}
+
+static void drop_back_rows(int count) {
+  s_reminder_count -= count;
+}
+
+// Grow the window to cover rows [start, end), dropping rows from the far
+// side if it would exceed MAX_REMINDERS. New slots hold no strings until
+// their row arrives. A range that does not touch the window replaces it
+// when replace is set and is refused otherwise.
+static bool cover_rows(int start, int end, bool replace) {
+  int window_end = s_window_start + s_reminder_count;
+
+  if (s_reminder_count == 0 || end < s_window_start || start > window_end) {
+    if (s_reminder_count > 0 && !replace) {
+      return false;
+    }
+    s_reminder_count = 0;
+    s_window_start = start;
+    arena_reset(&s_reminder_arena);
+    window_end = start;
+  }
+
+  if (start < s_window_start) {
+    int shift = s_window_start - start;
+    int overflow = s_reminder_count + shift - MAX_REMINDERS;
+    if (overflow > 0) {
+      drop_back_rows(MIN(overflow, s_reminder_count));
+    }
+    memmove(&s_reminders[shift], &s_reminders[0], s_reminder_count * sizeof(Reminder));
+    for (int i = 0; i < shift; i++) {
+      s_reminders[i] = (Reminder){ .handle = HANDLE_NONE, .title = STR_NONE, .completed = false };
+    }
+    s_reminder_count += shift;
+    s_window_start = start;
+    window_end = s_window_start + s_reminder_count;
+  }
+
+  if (end > window_end) {
+    int grow = end - window_end;
+    int overflow = s_reminder_count + grow - MAX_REMINDERS;
+    if (overflow > 0) {
+      drop_front_rows(MIN(overflow, s_reminder_count));
+    }
+    for (int i = 0; i < grow; i++) {
+      s_reminders[s_reminder_count++] = (Reminder){ .handle = HANDLE_NONE, .title = STR_NONE, .completed = false };
+    }
+  }
+  return true;
+}
+
+// Make arena space by dropping the resident rows on the larger side of
+// rows [start, end). Returns false if there was nothing left to drop.
+static bool drop_rows_outside(int start, int end) {
+  int before = start - s_window_start;
+  int after = s_window_start + s_reminder_count - end;
+  if (before <= 0 && after <= 0) {
+    return false;
+  }
+  if (before >= after) {
+    drop_front_rows(before);
+  } else {
+    drop_back_rows(after);
+  }
+  compact_reminder_arena();
+  return true;
+}
+
+// Apply count reminder items found at offset to list rows from start;
+// returns the offset after the last item read. Paged batches may move the
+// window anywhere; others only update rows in or next to it. When the
+// arena fills up it is compacted, then rows far from the batch are paged
+// out.
+static uint16_t apply_reminder_batch(int start, int count, const uint8_t *data, uint16_t length,
+                                     uint16_t offset, bool paged) {
+  count = MIN(count, MIN(MAX_REMINDERS, s_reminder_total - start));
+  if (start < 0 || count <= 0 || !cover_rows(start, start + count, paged)) {
+    return offset;
+  }
+
+  for (int i = 0; i < count; i++) {
+    int row = start + i;
+    Reminder *reminder = resident_reminder(row);
+    uint32_t handle;
+    uint32_t packed;
+    if (!read_varint(data, length, &offset, &handle) ||
+        !read_varint(data, length, &offset, &packed)) {
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Truncated reminder batch at %d", row);
+      break;
+    }
+    uint16_t title_offset = offset;
+    if (!read_batch_title(data, length, &offset, packed >> 1, &s_reminder_arena, &reminder->title)) {
+      APP_LOG(APP_LOG_LEVEL_ERROR, "Truncated reminder batch at %d", row);
+      break;
+    }
+    if (reminder->title == STR_NONE) {
+      // Reclaim the titles of rewritten rows, then page out rows far
+      // from this batch until the row fits
+      bool stored = false;
+      bool compacted = false;
+      do {
+        reminder->title = STR_NONE;
+        if (!compacted) {
+          compact_reminder_arena();
+          compacted = true;
+        } else if (!drop_rows_outside(start, start + count)) {
+          break;
+        }
+        reminder = resident_reminder(row);
+        offset = title_offset;
+        read_batch_title(data, length, &offset, packed >> 1, &s_reminder_arena, &reminder->title);
+        stored = reminder->title != STR_NONE;
+      } while (!stored);
+
+      if (!stored) {
+        APP_LOG(APP_LOG_LEVEL_WARNING, "Reminder arena full at row %d", row);
+        reminder->handle = HANDLE_NONE;
+        s_rows_truncated = true;
+        s_sync_token[0] = '\0';
+        break;
+      }
+    }
+    reminder->handle = handle;
+    reminder->completed = packed & 1;
+  }
+  return offset;
+}
+
+// Offline cache
+// Lists and the last opened list's reminders are saved on exit so the next
+// launch can draw them before the phone answers. The blob is
+// [list count][list items][rows list handle][sync token][reminder count]
+// [reminder items], items and handle encoded as in batches, split into
+// PERSIST_DATA_MAX_LENGTH chunks after a CacheHeader. Handles in it
+// belong to s_handle_epoch.
+#define PERSIST_KEY_CACHE_HEADER 10
+#define PERSIST_KEY_CACHE_CHUNK_BASE 11
+#define CACHE_VERSION 2
+#define CACHE_MAX_CHUNKS 12
+#define CACHE_MAX_BYTES (CACHE_MAX_CHUNKS * PERSIST_DATA_MAX_LENGTH)
+
+typedef struct {
+  uint8_t version;
+  uint8_t chunk_count;
+  uint16_t length;
+} CacheHeader;
+
+static bool write_batch_string(uint8_t *data, uint16_t size, uint16_t *offset, const char *str) {
+  size_t str_len = strlen(str);
+  if (str_len > 255) {
+    str_len = 255;
+  }
+  if (*offset + 1 + str_len > size) {
+    return false;
+  }
+  data[(*offset)++] = str_len;
+  memcpy(&data[*offset], str, str_len);
+  *offset += str_len;
+  return true;
+}
+
+static bool write_varint(uint8_t *data, uint16_t size, uint16_t *offset, uint32_t value) {
+  do {
+    if (*offset >= size) {
+      return false;
+    }
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    data[(*offset)++] = value ? byte | 0x80 : byte;
+  } while (value);
+  return true;
+}
+
+// Write [handle][title length << flag_bits | flags][title]
+static bool write_batch_item(uint8_t *data, uint16_t size, uint16_t *offset, Handle handle,
+                             const char *title, int flag_bits, uint32_t flags) {
+  size_t title_len = strlen(title);
+  if (!write_varint(data, size, offset, handle) ||
+      !write_varint(data, size, offset, (title_len << flag_bits) | flags) ||
+      *offset + title_len > size) {
+    return false;
+  }
+  memcpy(&data[*offset], title, title_len);
+  *offset += title_len;
+  return true;
+}
+
+static void clear_cache(void) {
+  persist_delete(PERSIST_KEY_CACHE_HEADER);
+  for (int i = 0; i < CACHE_MAX_CHUNKS; i++) {
+    persist_delete(PERSIST_KEY_CACHE_CHUNK_BASE + i);
+  }
+}
+
+static void save_cache(void) {
+  uint8_t *data = malloc(CACHE_MAX_BYTES);
+  if (!data) {
+    APP_LOG(APP_LOG_LEVEL_ERROR, "No memory to save cache");
+    return;
+  }
+  uint16_t offset = 0;
+
+  // Lists come first since they are what the app opens on; keep room
+  // for an empty reminders section
+  uint16_t lists_limit = CACHE_MAX_BYTES - 3;
+  uint16_t count_offset = offset++;
+  data[count_offset] = 0;
+  for (int i = 0; i < s_list_count; i++) {
+    uint16_t mark = offset;
+    if (!write_batch_item(data, lists_limit, &offset, s_lists[i].handle,
+                          arena_get(&s_list_arena, s_lists[i].title), 0, 0)) {
+      offset = mark;
+      break;
+    }
+    data[count_offset]++;
+  }
+
+  // Reminders fill what is left, provided the window starts at the top of
+  // the list. A partial list no longer matches its sync token, so the
+  // token is dropped in that case.
+  uint16_t section_start = offset;
+  bool complete = s_window_start == 0 &&
+                  write_varint(data, CACHE_MAX_BYTES, &offset, s_rows_list);
+  uint16_t token_offset = offset;
+  complete = complete && write_batch_string(data, CACHE_MAX_BYTES, &offset, s_sync_token);
+  if (complete && offset < CACHE_MAX_BYTES) {
+    count_offset = offset++;
+    data[count_offset] = 0;
+    for (int i = 0; i < s_reminder_count; i++) {
+      // The batch count is a single byte, and rows still being paged in
+      // have nothing to save
+      if (i == 255 || s_reminders[i].title == STR_NONE) {
+        complete = false;
+        break;
+      }
+      uint16_t mark = offset;
+      if (!write_batch_item(data, CACHE_MAX_BYTES, &offset, s_reminders[i].handle,
+                            arena_get(&s_reminder_arena, s_reminders[i].title),
+                            1, s_reminders[i].completed ? 1 : 0)) {
+        offset = mark;
+        complete = false;
+        break;
+      }
+      data[count_offset]++;
+    }
+    if (!complete) {
+      // Rewrite the token as empty and shift the rows down over it
+      uint16_t token_len = data[token_offset];
+      memmove(&data[token_offset + 1], &data[token_offset + 1 + token_len],
+              offset - (token_offset + 1 + token_len));
+      data[token_offset] = 0;
+      offset -= token_len;
+    }
+  } else {
+    offset = section_start;
+    data[offset++] = 0;
+    data[offset++] = 0;
+    data[offset++] = 0;
+  }
+
+  CacheHeader header = {
+    .version = CACHE_VERSION,
+    .chunk_count = (offset + PERSIST_DATA_MAX_LENGTH - 1) / PERSIST_DATA_MAX_LENGTH,
+    .length = offset,
+  };
+  for (int i = 0; i < header.chunk_count; i++) {
+    uint16_t chunk_start = i * PERSIST_DATA_MAX_LENGTH;
+    uint16_t chunk_len = MIN(PERSIST_DATA_MAX_LENGTH, offset - chunk_start);
+    persist_write_data(PERSIST_KEY_CACHE_CHUNK_BASE + i, &data[chunk_start], chunk_len);
+  }
+  for (int i = header.chunk_count; i < CACHE_MAX_CHUNKS; i++) {
+    persist_delete(PERSIST_KEY_CACHE_CHUNK_BASE + i);
+  }
+
+  // Header last, so an interrupted save leaves the old header pointing
+  // at chunks that fail the length checks below
+  persist_write_data(PERSIST_KEY_CACHE_HEADER, &header, sizeof(header));
+  free(data);
+}
+
+static void load_cache(void) {
+  if (!persist_exists(PERSIST_KEY_CACHE_HEADER)) {
+    return;
+  }
+
+  CacheHeader header;
+  if (persist_read_data(PERSIST_KEY_CACHE_HEADER, &header, sizeof(header)) != sizeof(header) ||
+      header.version != CACHE_VERSION || header.chunk_count > CACHE_MAX_CHUNKS ||
+      header.length > header.chunk_count * PERSIST_DATA_MAX_LENGTH || header.length < 4) {
+    clear_cache();
+    return;
+  }
+
+  uint8_t *data = malloc(header.length);
+  if (!data) {
+    return;
+  }
+  for (int i = 0; i < header.chunk_count; i++) {
+    uint16_t chunk_start = i * PERSIST_DATA_MAX_LENGTH;
+    int chunk_len = MIN(PERSIST_DATA_MAX_LENGTH, header.length - chunk_start);
+    if (persist_read_data(PERSIST_KEY_CACHE_CHUNK_BASE + i, &data[chunk_start], chunk_len) != chunk_len) {
+      APP_LOG(APP_LOG_LEVEL_WARNING, "Discarding incomplete cache");
+      free(data);
+      clear_cache();
+      return;
+    }
+  }
+
+  s_list_count = MIN(data[0], MAX_LISTS);
+  uint16_t offset = apply_list_batch(0, s_list_count, data, header.length, 1);
+
+  uint32_t rows_list;
+  if (read_varint(data, header.length, &offset, &rows_list) && rows_list <= UINT16_MAX &&
+      read_batch_string(data, header.length, &offset, s_sync_token, sizeof(s_sync_token)) &&
+      offset < header.length) {
+    s_rows_list = rows_list;
+    s_reminder_total = data[offset];
+    apply_reminder_batch(0, s_reminder_total, data, header.length, offset + 1, true);
+  }
+
+  free(data);
+  APP_LOG(APP_LOG_LEVEL_INFO, "Loaded %d lists and %d reminders from cache", s_list_count, s_reminder_count);
+}
+
+// Completion outbox
+// Completions show on the watch at once and wait here until the phone
+// confirms them. The queue is persisted so completions made while the
+// phone is away survive an exit, and is replayed when it reconnects.
+#define PERSIST_KEY_HANDLE_EPOCH 41
+#define PERSIST_KEY_OUTBOX 42
+#define OUTBOX_MAX 32
+#define OUTBOX_RETRY_MIN_MS 2000
+#define OUTBOX_RETRY_MAX_MS 60000
+
+// Outbox keys from before handles, one entry of GUID strings per key
+#define PERSIST_KEY_LEGACY_OUTBOX_COUNT 30
+#define PERSIST_KEY_LEGACY_OUTBOX_BASE 31
+#define LEGACY_OUTBOX_MAX 8
+// Outbox of list and reminder handles without their epoch
+#define PERSIST_KEY_OUTBOX_V1 40
+
+// Handles are only meaningful with the epoch they were issued in. The
+// phone keeps the previous epoch's table, so completions queued before an
+// epoch change still resolve after it.
+typedef struct {
+  Handle list;
+  Handle reminder;
+  uint16_t epoch;
+} PendingCompletion;
+
+static PendingCompletion s_outbox[OUTBOX_MAX];
+static int s_outbox_count = 0;
+// s_outbox[0..s_outbox_sent) reached the phone and await its reply;
+// s_outbox_sending is set while the next one is in the AppMessage outbox
+static int s_outbox_sent = 0;
+static bool s_outbox_sending = false;
+static AppTimer *s_outbox_retry_timer = NULL;
+static uint32_t s_outbox_retry_ms = OUTBOX_RETRY_MIN_MS;
+
+static void save_outbox(void) {
+  if (s_outbox_count > 0) {
+    persist_write_data(PERSIST_KEY_OUTBOX, s_outbox, s_outbox_count * sizeof(PendingCompletion));
+  } else {
+    persist_delete(PERSIST_KEY_OUTBOX);
+  }
+}
+
+static void load_outbox(void) {
+  s_handle_epoch = persist_read_int(PERSIST_KEY_HANDLE_EPOCH);
+
+  // Legacy entries name GUIDs the phone no longer accepts
+  if (persist_exists(PERSIST_KEY_LEGACY_OUTBOX_COUNT)) {
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Dropping %d completions queued by an older version",
+            (int)persist_read_int(PERSIST_KEY_LEGACY_OUTBOX_COUNT));
+    persist_delete(PERSIST_KEY_LEGACY_OUTBOX_COUNT);
+    for (int i = 0; i < LEGACY_OUTBOX_MAX; i++) {
+      persist_delete(PERSIST_KEY_LEGACY_OUTBOX_BASE + i);
+    }
+  }
+
+  if (persist_exists(PERSIST_KEY_OUTBOX_V1)) {
+    Handle pairs[OUTBOX_MAX][2];
+    int bytes = persist_read_data(PERSIST_KEY_OUTBOX_V1, pairs, sizeof(pairs));
+    s_outbox_count = bytes > 0 ? bytes / (int)sizeof(pairs[0]) : 0;
+    for (int i = 0; i < s_outbox_count; i++) {
+      s_outbox[i] = (PendingCompletion){ .list = pairs[i][0], .reminder = pairs[i][1], .epoch = s_handle_epoch };
+    }
+    persist_delete(PERSIST_KEY_OUTBOX_V1);
+    save_outbox();
+  } else {
+    int bytes = persist_read_data(PERSIST_KEY_OUTBOX, s_outbox, sizeof(s_outbox));
+    s_outbox_count = bytes > 0 ? bytes / (int)sizeof(PendingCompletion) : 0;
+  }
+  if (s_outbox_count > 0) {
+    APP_LOG(APP_LOG_LEVEL_INFO, "%d completions waiting to be sent", s_outbox_count);
+  }
+}
+
+static int outbox_find(uint16_t epoch, Handle reminder) {
+  for (int i = 0; i < s_outbox_count; i++) {
+    if (s_outbox[i].reminder == reminder && s_outbox[i].epoch == epoch) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void outbox_remove(int index) {
+  memmove(&s_outbox[index], &s_outbox[index + 1], (s_outbox_count - index - 1) * sizeof(PendingCompletion));
+  s_outbox_count--;
+  save_outbox();
+}
+
+// Return the resident row with this reminder handle, or NULL
+static Reminder *find_reminder(Handle list, Handle reminder) {
+  if (list != s_rows_list || reminder == HANDLE_NONE) {
+    return NULL;
+  }
+  for (int i = 0; i < s_reminder_count; i++) {
+    if (s_reminders[i].handle == reminder) {
+      return &s_reminders[i];
+    }
+  }
+  return NULL;
+}
+
+// The resident row a queued completion is for, or NULL. Entries from an
+// earlier epoch name no row the watch holds now.
+static Reminder *outbox_row(const PendingCompletion *entry) {
+  if (entry->epoch != s_handle_epoch) {
+    return NULL;
+  }
+  return find_reminder(entry->list, entry->reminder);
+}
+
+// Keep pending completions showing over rows the phone sent before it
+// had applied them
+static void apply_outbox_to_rows(void) {
+  for (int i = 0; i < s_outbox_count; i++) {
+    Reminder *reminder = outbox_row(&s_outbox[i]);
+    if (reminder) {
+      reminder->completed = true;
+    }
+  }
+}
+
+// Resend everything the phone has not confirmed yet
+static void outbox_rewind(void) {
+  s_outbox_sent = 0;
+  s_outbox_sending = false;
+}
+
+// Handles only hold within the epoch the phone issued them in, so a new
+// epoch invalidates the held rows. Queued completions keep their own
+// epoch and are still sent; the phone resolves the previous one too.
+static void adopt_handle_epoch(uint16_t epoch) {
+  if (epoch == s_handle_epoch) {
+    return;
+  }
+  APP_LOG(APP_LOG_LEVEL_INFO, "Handle epoch %d -> %d, %d completions still queued",
+          s_handle_epoch, epoch, s_outbox_count);
+  s_handle_epoch = epoch;
+  persist_write_int(PERSIST_KEY_HANDLE_EPOCH, epoch);
+
+  clear_rows();
+  clear_prefetched_lists();
+  for (int i = 0; i < s_list_count; i++) {
+    s_lists[i].handle = HANDLE_NONE;
+  }
+}
+
+static void outbox_flush(void);
+
+static void outbox_retry_callback(void *context) {
+  s_outbox_retry_timer = NULL;
+  outbox_rewind();
+  outbox_flush();
+}
+
+static void schedule_outbox_retry(void) {
+  if (s_outbox_retry_timer || s_outbox_count == 0) {
+    return;
+  }
+  s_outbox_retry_timer = app_timer_register(s_outbox_retry_ms, outbox_retry_callback, NULL);
+  s_outbox_retry_ms = MIN(s_outbox_retry_ms * 2, OUTBOX_RETRY_MAX_MS);
+}
+
+// Hand the next unsent completion to the phone. Completions go out back
+// to back without waiting for replies, so the phone can batch them into
+// one backend request.
+static void outbox_flush(void) {
+  if (s_outbox_sending || s_outbox_sent >= s_outbox_count) {
+    return;
+  }
+  if (!connection_service_peek_pebble_app_connection()) {
+    // Replayed by phone_connection_handler
+    return;
+  }
+  PendingCompletion *entry = &s_outbox[s_outbox_sent];
+  if (send_complete_reminder_request(entry->list, entry->reminder, entry->epoch)) {
+    s_outbox_sending = true;
+  } else {
+    schedule_outbox_retry();
+  }
+}
+
+
+// Queue a completion and show it straight away
+static bool outbox_add(Handle list, Reminder *reminder) {
+  if (reminder->handle == HANDLE_NONE) {
+    return false;
+  }
+  if (outbox_find(s_handle_epoch, reminder->handle) < 0) {
+    if (s_outbox_count == OUTBOX_MAX) {
+      return false;
+    }
+    s_outbox[s_outbox_count++] = (PendingCompletion){
+      .list = list, .reminder = reminder->handle, .epoch = s_handle_epoch
+    };
+    save_outbox();
+  }
+  reminder->completed = true;
+  outbox_flush();
+  return true;
+}
+
+// The phone confirmed or rejected a completion
+static void outbox_resolve(uint16_t epoch, Handle reminder_handle, bool completed) {
+  int index = outbox_find(epoch, reminder_handle);
+  if (index >= 0) {
+    if (index < s_outbox_sent) {
+      s_outbox_sent--;
+    }
+    if (!completed) {
+      Reminder *reminder = outbox_row(&s_outbox[index]);
+      if (reminder) {
+        reminder->completed = false;
+      }
+    }
+    outbox_remove(index);
+  }
+  s_outbox_retry_ms = OUTBOX_RETRY_MIN_MS;
+  outbox_flush();
+}
+
+static void phone_connection_handler(bool connected) {
+  if (connected) {
+    // Replies to anything sent before the drop may never come
+    s_outbox_retry_ms = OUTBOX_RETRY_MIN_MS;
+    outbox_rewind();
+    outbox_flush();
+  } else {
+    // Whatever was in flight has to be resent
+    outbox_rewind();
+  }
+}
+
+// List prefetch
+// Resting on a list in the main menu for PREFETCH_DWELL_MS asks the phone
+// for the first batch of its reminders. The last few answers are kept
+// here, so opening one of those lists draws at once and the phone only
+// has to send what changed since.
+#define PREFETCH_DWELL_MS 400
+#if defined(PBL_PLATFORM_APLITE)
+#define PREFETCH_SLOTS 2
+#else
+#define PREFETCH_SLOTS 4
+#endif
+// One batch, as sized by the phone
+#define PREFETCH_MAX_BYTES 400
+
+typedef struct {
+  Handle list;
+  uint16_t total;
+  uint16_t length;
+  uint32_t last_used;
+  char sync_token[64];
+  uint8_t batch[PREFETCH_MAX_BYTES];
+} PrefetchedList;
+
+// Slots with a list of HANDLE_NONE are free
+static PrefetchedList s_prefetched[PREFETCH_SLOTS];
+static uint32_t s_prefetch_clock = 0;
+static AppTimer *s_prefetch_timer = NULL;
+
+static PrefetchedList *find_prefetched(Handle list) {
+  if (list == HANDLE_NONE) {
+    return NULL;
+  }
+  for (int i = 0; i < PREFETCH_SLOTS; i++) {
+    if (s_prefetched[i].list == list) {
+      return &s_prefetched[i];
+    }
+  }
+  return NULL;
+}
+
+static void clear_prefetched_lists(void) {
+  for (int i = 0; i < PREFETCH_SLOTS; i++) {
+    s_prefetched[i].list = HANDLE_NONE;
+    s_prefetched[i].last_used = 0;
+  }
+}
+
+// Keep a prefetched batch in this list's slot, or else the least
+// recently used one
+static void store_prefetched(Handle list, int total, const char *sync_token,
+                             const uint8_t *batch, uint16_t length) {
+  if (list == HANDLE_NONE || length > PREFETCH_MAX_BYTES) {
+    return;
+  }
+  PrefetchedList *slot = find_prefetched(list);
+  if (!slot) {
+    slot = &s_prefetched[0];
+    for (int i = 1; i < PREFETCH_SLOTS; i++) {
+      if (s_prefetched[i].last_used < slot->last_used) {
+        slot = &s_prefetched[i];
+      }
+    }
+  }
+  slot->list = list;
+  slot->total = total;
+  slot->length = length;
+  slot->last_used = ++s_prefetch_clock;
+  snprintf(slot->sync_token, sizeof(slot->sync_token), "%s", sync_token);
+  memcpy(slot->batch, batch, length);
+}
+
+// Make a prefetched list the held rows; false if none was kept for it
+static bool take_prefetched_rows(Handle list) {
+  PrefetchedList *slot = find_prefetched(list);
+  BatchHeader batch;
+  uint16_t offset;
+  if (!slot || !read_batch_header(slot->batch, slot->length, &offset, &batch) || batch.list != list) {
+    return false;
+  }
+
+  clear_rows();
+  s_rows_list = list;
+  s_reminder_total = slot->total;
+  snprintf(s_sync_token, sizeof(s_sync_token), "%s", slot->sync_token);
+  apply_reminder_batch(batch.start, batch.count, slot->batch, slot->length, offset, true);
+  apply_outbox_to_rows();
+
+  // The held rows are the copy kept up to date from here on
+  slot->list = HANDLE_NONE;
+  slot->last_used = 0;
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Opened list from prefetch with %d of %d rows",
+          s_reminder_count, s_reminder_total);
+  return true;
+}
+
+static void prefetch_timer_callback(void *context) {
+  s_prefetch_timer = NULL;
+  if (!s_menu_layer || s_reminders_window) {
+    return;
+  }
+  int row = menu_layer_get_selected_index(s_menu_layer).row;
+  if (row >= s_list_count) {
+    return;
+  }
+  Handle list = s_lists[row].handle;
+  if (list == HANDLE_NONE || list == s_rows_list || find_prefetched(list)) {
+    return;
+  }
+  // Completions and requests waiting to go out come first
+  if (s_outbox_sending || s_outbox_sent < s_outbox_count || has_deferred_request()) {
+    return;
+  }
+  send_prefetch_request(list);
+}
+
+// Menu redraws
+// Messages mark menu rows dirty instead of reloading the menu, and a timer
+// flushes once per frame: a row count change reloads the menu, a change
+// to rows that may be on screen repaints it, anything else is dropped.
+#define REDRAW_FRAME_MS 33
+#define MENU_ROW_HEIGHT 44
+
+typedef struct {
+  // Dirty rows are [dirty_start, dirty_end); empty when start >= end
+  int dirty_start;
+  int dirty_end;
+  bool reload;
+} MenuRedraw;
+
+static MenuRedraw s_lists_redraw = { 0, 0, false };
+static MenuRedraw s_reminders_redraw = { 0, 0, false };
+static AppTimer *s_redraw_timer = NULL;
+
+// Updates marked vs. work done, to check how much the coalescing saves
+static int s_redraw_updates = 0;
+static int s_redraw_reloads = 0;
+static int s_redraw_repaints = 0;
+static int s_redraw_skipped = 0;
+
+static void redraw_timer_callback(void *context);
+
+static void schedule_redraw(void) {
+  s_redraw_updates++;
+  if (!s_redraw_timer) {
+    s_redraw_timer = app_timer_register(REDRAW_FRAME_MS, redraw_timer_callback, NULL);
+  }
+}
+
+static void mark_rows_dirty(MenuRedraw *redraw, int start, int end) {
+  if (start >= end) {
+    return;
+  }
+  if (redraw->dirty_start >= redraw->dirty_end) {
+    redraw->dirty_start = start;
+    redraw->dirty_end = end;
+  } else {
+    redraw->dirty_start = MIN(redraw->dirty_start, start);
+    redraw->dirty_end = MAX(redraw->dirty_end, end);
+  }
+  schedule_redraw();
+}
+
+static void mark_menu_reload(MenuRedraw *redraw) {
+  redraw->reload = true;
+  schedule_redraw();
+}
+
+static void flush_menu_redraw(MenuLayer *menu_layer, MenuRedraw *redraw) {
+  if (menu_layer && redraw->reload) {
+    menu_layer_reload_data(menu_layer);
+    s_redraw_reloads++;
+  } else if (menu_layer && redraw->dirty_start < redraw->dirty_end) {
+    // The selection can be anywhere on screen, so rows up to a screen
+    // away from it on either side may be visible
+    Layer *layer = menu_layer_get_layer(menu_layer);
+    int screen_rows = layer_get_bounds(layer).size.h / MENU_ROW_HEIGHT + 1;
+    int selected = menu_layer_get_selected_index(menu_layer).row;
+    if (redraw->dirty_start <= selected + screen_rows && redraw->dirty_end > selected - screen_rows) {
+      layer_mark_dirty(layer);
+      s_redraw_repaints++;
+    } else {
+      s_redraw_skipped++;
+    }
+  }
+  redraw->reload = false;
+  redraw->dirty_start = 0;
+  redraw->dirty_end = 0;
+}
+
+static void redraw_timer_callback(void *context) {
+  s_redraw_timer = NULL;
+  flush_menu_redraw(s_menu_layer, &s_lists_redraw);
+  flush_menu_redraw(s_reminders_window ? s_reminders_menu_layer : NULL, &s_reminders_redraw);
+  APP_LOG(APP_LOG_LEVEL_DEBUG, "Redraw: %d updates -> %d reloads, %d repaints, %d skipped",
+          s_redraw_updates, s_redraw_reloads, s_redraw_repaints, s_redraw_skipped);
+}
+
 // AppMessage callbacks
 static void inbox_received_callback(DictionaryIterator *iterator, void *context) {
   Tuple *cmd_tuple = dict_find(iterator, KEY_CMD);
@@ -125,6 +1153,39 @@ static void inbox_received_callback(DictionaryIterator *iterator, void *context)
   Tuple *status_tuple = dict_find(iterator, KEY_STATUS);
   int status = status_tuple ? status_tuple->value->int32 : STATUS_ERROR;
 
+  // Replies echo the epoch the completion was sent under
+  Tuple *reply_epoch_tuple = dict_find(iterator, KEY_HANDLE_EPOCH);
+  uint16_t reply_epoch = reply_epoch_tuple ? reply_epoch_tuple->value->int32 : s_handle_epoch;
+
+  if (status == STATUS_ERROR && cmd == CMD_COMPLETE_REMINDER) {
+    Tuple *reminder_id_tuple = dict_find(iterator, KEY_REMINDER_ID);
+    Tuple *action_tuple = dict_find(iterator, KEY_ACTION);
+    if (action_tuple && action_tuple->value->int32 == ACTION_RETRY) {
+      // Backend unreachable; keep the completion showing and try later
+      APP_LOG(APP_LOG_LEVEL_WARNING, "Completion deferred");
+      schedule_outbox_retry();
+      return;
+    }
+
+    // Rejected; roll the row back and report it below
+    outbox_resolve(reply_epoch, reminder_id_tuple ? reminder_id_tuple->value->int32 : HANDLE_NONE, false);
+    mark_rows_dirty(&s_reminders_redraw, s_window_start, s_window_start + s_reminder_count);
+  }
+
+  if (status == STATUS_ERROR && cmd == CMD_PREFETCH_REMINDERS) {
+    // Nothing was waiting on it
+    APP_LOG(APP_LOG_LEVEL_DEBUG, "Prefetch failed");
+    return;
+  }
+
+  if (status == STATUS_ERROR && cmd == CMD_GET_REMINDER_PAGE) {
+    // A failed prefetch is retried when the rows are next drawn
+    APP_LOG(APP_LOG_LEVEL_WARNING, "Reminder page request failed");
+    s_page_pending_start = -1;
+    s_page_pending_end = -1;
+    return;
+  }
+
   if (status == STATUS_ERROR) {
     Tuple *error_tuple = dict_find(iterator, KEY_ERROR);
     const char *error = error_tuple ? error_tuple->value->cstring : "Unknown error";
@@ -157,6 +1218,13 @@ static void inbox_received_callback(DictionaryIterator *iterator, void *context)
         s_is_logged_in = true;
         save_settings();
 
+        // Cached rows may belong to another account
+        clear_cache();
+        s_list_count = 0;
+        clear_rows();
+        clear_prefetched_lists();
+        mark_menu_reload(&s_lists_redraw);
+
         // Close settings window and request lists
         window_stack_remove(s_settings_window, true);
         send_get_lists_request();
@@ -173,8 +1241,20 @@ static void inbox_received_callback(DictionaryIterator *iterator, void *context)
           s_list_count = MAX_LISTS;
         }
 
+        // Handles from another epoch may now name other reminders
+        Tuple *epoch_tuple = dict_find(iterator, KEY_HANDLE_EPOCH);
+        if (epoch_tuple) {
+          adopt_handle_epoch(epoch_tuple->value->int32);
+          mark_menu_reload(&s_reminders_redraw);
+        }
+
         // Lists are sent in subsequent messages with KEY_REMINDER_INDEX
-        menu_layer_reload_data(s_menu_layer);
+        mark_menu_reload(&s_lists_redraw);
+
+        // The phone is reachable again; replay completions made meanwhile,
+        // and any it took but never answered. Completing twice is harmless.
+        outbox_rewind();
+        outbox_flush();
       }
       break;
     }
@@ -183,84 +1263,174 @@ static void inbox_received_callback(DictionaryIterator *iterator, void *context)
       // Parse reminders
       Tuple *count_tuple = dict_find(iterator, KEY_COUNT);
       if (count_tuple) {
-        s_reminder_count = count_tuple->value->int32;
-        if (s_reminder_count > MAX_REMINDERS) {
-          s_reminder_count = MAX_REMINDERS;
+        // Rows are about to change; the token is only valid once they have.
+        // Rows of another list are of no use, so their strings go too.
+        Tuple *list_tuple = dict_find(iterator, KEY_LIST_ID);
+        if (list_tuple && s_rows_list != (Handle)list_tuple->value->int32) {
+          clear_rows();
+          s_rows_list = list_tuple->value->int32;
+        }
+        s_sync_token[0] = '\0';
+        s_rows_truncated = false;
+        s_page_pending_start = -1;
+        s_page_pending_end = -1;
+
+        // KEY_COUNT is the full list length; only the resident window is
+        // resent, so trim it to the new length
+        s_reminder_total = count_tuple->value->int32;
+        if (s_window_start >= s_reminder_total) {
+          s_reminder_count = 0;
+          s_window_start = 0;
+        } else if (s_window_start + s_reminder_count > s_reminder_total) {
+          s_reminder_count = s_reminder_total - s_window_start;
         }
 
         // Reminders are sent in subsequent messages
-        if (s_reminders_window) {
-          menu_layer_reload_data(s_reminders_menu_layer);
-        }
+        mark_menu_reload(&s_reminders_redraw);
       }
       break;
     }
 
-    case CMD_COMPLETE_REMINDER: {
-      // Reminder marked as complete
-      if (status == STATUS_SUCCESS) {
-        // Update local state
-        if (s_current_reminder_index >= 0 && s_current_reminder_index < s_reminder_count) {
-          s_reminders[s_current_reminder_index].completed = true;
-        }
+    case CMD_PREFETCH_REMINDERS: {
+      // Kept for when the list is opened; nothing on screen changes
+      Tuple *count_tuple = dict_find(iterator, KEY_COUNT);
+      Tuple *prefetch_tuple = dict_find(iterator, KEY_BATCH);
+      Tuple *sync_token_tuple = dict_find(iterator, KEY_SYNC_TOKEN);
+      BatchHeader prefetch;
+      uint16_t offset;
+      if (count_tuple && prefetch_tuple && sync_token_tuple &&
+          read_batch_header(prefetch_tuple->value->data, prefetch_tuple->length, &offset, &prefetch)) {
+        store_prefetched(prefetch.list, count_tuple->value->int32, sync_token_tuple->value->cstring,
+                         prefetch_tuple->value->data, prefetch_tuple->length);
+      }
+      break;
+    }
 
-        // Close detail window and refresh list
-        window_stack_remove(s_detail_window, true);
-        menu_layer_reload_data(s_reminders_menu_layer);
+    case CMD_COMPLETE_REMINDER: {
+      // The row already shows as complete; drop it from the outbox
+      Tuple *reminder_id_tuple = dict_find(iterator, KEY_REMINDER_ID);
+      if (status == STATUS_SUCCESS && reminder_id_tuple) {
+        outbox_resolve(reply_epoch, reminder_id_tuple->value->int32, true);
       }
       break;
     }
   }
 
-  // Check for individual list/reminder data
-  Tuple *index_tuple = dict_find(iterator, KEY_REMINDER_INDEX);
-  if (index_tuple) {
-    int index = index_tuple->value->int32;
-
-    // Check if this is a list or reminder
-    Tuple *list_id_tuple = dict_find(iterator, KEY_LIST_ID);
-    Tuple *list_title_tuple = dict_find(iterator, KEY_LIST_TITLE);
-    Tuple *reminder_id_tuple = dict_find(iterator, KEY_REMINDER_ID);
-    Tuple *reminder_title_tuple = dict_find(iterator, KEY_REMINDER_TITLE);
-    Tuple *completed_tuple = dict_find(iterator, KEY_REMINDER_COMPLETED);
-
-    if (list_id_tuple && list_title_tuple && index < MAX_LISTS) {
-      // This is a list
-      snprintf(s_lists[index].id, sizeof(s_lists[index].id), "%s", list_id_tuple->value->cstring);
-      snprintf(s_lists[index].title, sizeof(s_lists[index].title), "%s", list_title_tuple->value->cstring);
-      menu_layer_reload_data(s_menu_layer);
-    } else if (reminder_id_tuple && reminder_title_tuple && index < MAX_REMINDERS) {
-      // This is a reminder
-      snprintf(s_reminders[index].id, sizeof(s_reminders[index].id), "%s", reminder_id_tuple->value->cstring);
-      snprintf(s_reminders[index].title, sizeof(s_reminders[index].title), "%s", reminder_title_tuple->value->cstring);
-      if (list_id_tuple) {
-        snprintf(s_reminders[index].list_id, sizeof(s_reminders[index].list_id), "%s", list_id_tuple->value->cstring);
+  // Check for a batch of list/reminder rows
+  Tuple *batch_tuple = dict_find(iterator, KEY_BATCH);
+  BatchHeader batch;
+  uint16_t batch_offset;
+  if (batch_tuple && read_batch_header(batch_tuple->value->data, batch_tuple->length, &batch_offset, &batch)) {
+    if (cmd == CMD_GET_LISTS) {
+      int list_count = s_list_count;
+      apply_list_batch(batch.start, batch.count, batch_tuple->value->data, batch_tuple->length, batch_offset);
+      if (s_list_count != list_count) {
+        // The list arena filled up and rows were cut
+        mark_menu_reload(&s_lists_redraw);
+      } else {
+        mark_rows_dirty(&s_lists_redraw, batch.start, batch.start + batch.count);
       }
-      s_reminders[index].completed = completed_tuple ? completed_tuple->value->int32 : 0;
+    } else if (cmd == CMD_GET_REMINDERS || cmd == CMD_GET_REMINDER_PAGE) {
+      // Pages may still arrive for a list that has since been closed
+      if (cmd == CMD_GET_REMINDERS || (batch.list != HANDLE_NONE && batch.list == s_rows_list)) {
+        int old_start = s_window_start;
+        int old_end = s_window_start + s_reminder_count;
+        apply_reminder_batch(batch.start, batch.count, batch_tuple->value->data, batch_tuple->length,
+                             batch_offset, cmd == CMD_GET_REMINDER_PAGE);
+        apply_outbox_to_rows();
+        if (cmd == CMD_GET_REMINDER_PAGE && batch.start + batch.count >= s_page_pending_end) {
+          s_page_pending_start = -1;
+          s_page_pending_end = -1;
+        }
 
-      if (s_reminders_window) {
-        menu_layer_reload_data(s_reminders_menu_layer);
+        // Rows paged out draw as placeholders, so the old window is dirty too
+        int new_start = s_window_start;
+        int new_end = s_window_start + s_reminder_count;
+        if (old_start < old_end) {
+          new_start = MIN(new_start, old_start);
+          new_end = MAX(new_end, old_end);
+        }
+        mark_rows_dirty(&s_reminders_redraw, new_start, new_end);
       }
     }
   }
+
+  // A sync token arrives with the last message of a reminders response
+  Tuple *sync_token_tuple = dict_find(iterator, KEY_SYNC_TOKEN);
+  if (sync_token_tuple && cmd == CMD_GET_REMINDERS && !s_rows_truncated) {
+    snprintf(s_sync_token, sizeof(s_sync_token), "%s", sync_token_tuple->value->cstring);
+  }
 }
 
 static void inbox_dropped_callback(AppMessageResult reason, void *context) {
   APP_LOG(APP_LOG_LEVEL_ERROR, "Message dropped: %d", reason);
 }
 
+// Requests that found the AppMessage outbox busy with another message (a
+// prefetch, page or completion) are sent once it frees, newest first for
+// each kind
+static bool s_login_deferred = false;
+static bool s_lists_deferred = false;
+static Handle s_reminders_deferred = HANDLE_NONE;
+static int s_page_deferred = -1;
+
+// Send the most urgent deferred request; false if there was none
+static bool send_deferred_request(void) {
+  if (s_login_deferred) {
+    send_login_request();
+  } else if (s_lists_deferred) {
+    send_get_lists_request();
+  } else if (s_reminders_deferred != HANDLE_NONE) {
+    send_get_reminders_request(s_reminders_deferred);
+  } else if (s_page_deferred >= 0) {
+    send_get_reminder_page_request(s_page_deferred);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+static bool has_deferred_request(void) {
+  return s_login_deferred || s_lists_deferred || s_reminders_deferred != HANDLE_NONE ||
+         s_page_deferred >= 0;
+}
+
 static void outbox_failed_callback(DictionaryIterator *iterator, AppMessageResult reason, void *context) {
   APP_LOG(APP_LOG_LEVEL_ERROR, "Outbox send failed: %d", reason);
+
+  Tuple *cmd_tuple = dict_find(iterator, KEY_CMD);
+  if (cmd_tuple && cmd_tuple->value->int32 == CMD_COMPLETE_REMINDER) {
+    s_outbox_sending = false;
+    schedule_outbox_retry();
+  }
+  send_deferred_request();
 }
 
 static void outbox_sent_callback(DictionaryIterator *iterator, void *context) {
   APP_LOG(APP_LOG_LEVEL_INFO, "Outbox send success!");
+
+  // The phone has this completion
+  Tuple *cmd_tuple = dict_find(iterator, KEY_CMD);
+  if (cmd_tuple && cmd_tuple->value->int32 == CMD_COMPLETE_REMINDER && s_outbox_sending) {
+    s_outbox_sending = false;
+    s_outbox_sent = MIN(s_outbox_sent + 1, s_outbox_count);
+  }
+
+  // The outbox is free: what the user is waiting on goes first, then the
+  // next completion
+  if (!send_deferred_request()) {
+    outbox_flush();
+  }
 }
 
 // Send messages to phone
 static void send_login_request(void) {
   DictionaryIterator *iter;
-  app_message_outbox_begin(&iter);
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    s_login_deferred = true;
+    return;
+  }
+  s_login_deferred = false;
 
   dict_write_int(iter, KEY_CMD, &(int){CMD_LOGIN}, sizeof(int), true);
   dict_write_cstring(iter, KEY_USERNAME, s_username);
@@ -272,7 +1442,11 @@ static void send_login_request(void) {
 
 static void send_get_lists_request(void) {
   DictionaryIterator *iter;
-  app_message_outbox_begin(&iter);
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    s_lists_deferred = true;
+    return;
+  }
+  s_lists_deferred = false;
 
   dict_write_int(iter, KEY_CMD, &(int){CMD_GET_LISTS}, sizeof(int), true);
   dict_write_cstring(iter, KEY_TOKEN, s_token);
@@ -280,29 +1454,104 @@ static void send_get_lists_request(void) {
   app_message_outbox_send();
 }
 
-static void send_get_reminders_request(const char *list_id) {
+static void send_get_reminders_request(Handle list) {
   DictionaryIterator *iter;
-  app_message_outbox_begin(&iter);
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    s_reminders_deferred = list;
+    return;
+  }
+  s_reminders_deferred = HANDLE_NONE;
 
   dict_write_int(iter, KEY_CMD, &(int){CMD_GET_REMINDERS}, sizeof(int), true);
   dict_write_cstring(iter, KEY_TOKEN, s_token);
-  dict_write_cstring(iter, KEY_LIST_ID, list_id);
+  dict_write_uint16(iter, KEY_LIST_ID, list);
+  dict_write_uint16(iter, KEY_HANDLE_EPOCH, s_handle_epoch);
+
+  // Tell the phone which rows we hold so it resends that window, and
+  // only the rows that changed since our copy
+  if (s_rows_list == list) {
+    dict_write_int(iter, KEY_BATCH_START, &s_window_start, sizeof(int), true);
+    dict_write_int(iter, KEY_COUNT, &s_reminder_count, sizeof(int), true);
+    if (s_sync_token[0] != '\0') {
+      dict_write_cstring(iter, KEY_SYNC_TOKEN, s_sync_token);
+    }
+  }
 
   app_message_outbox_send();
 }
 
-static void send_complete_reminder_request(const char *list_id, const char *reminder_id) {
+// Ask the phone for the page of rows around row. Pages next to the
+// window extend it; anything further away replaces it.
+static void send_get_reminder_page_request(int row) {
+  if (row < 0 || row >= s_reminder_total) {
+    return;
+  }
+  if (row >= s_page_pending_start && row < s_page_pending_end) {
+    return;
+  }
+
+  int window_end = s_window_start + s_reminder_count;
+  int start;
+  if (row >= window_end && row < window_end + PAGE_ROWS) {
+    start = window_end;
+  } else if (row < s_window_start && row >= s_window_start - PAGE_ROWS) {
+    start = MAX(s_window_start - PAGE_ROWS, 0);
+  } else {
+    start = MAX(row - PAGE_ROWS / 2, 0);
+  }
+  int count = MIN(PAGE_ROWS, s_reminder_total - start);
+
   DictionaryIterator *iter;
-  app_message_outbox_begin(&iter);
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    s_page_deferred = row;
+    return;
+  }
+  s_page_deferred = -1;
 
-  dict_write_int(iter, KEY_CMD, &(int){CMD_COMPLETE_REMINDER}, sizeof(int), true);
+  dict_write_int(iter, KEY_CMD, &(int){CMD_GET_REMINDER_PAGE}, sizeof(int), true);
   dict_write_cstring(iter, KEY_TOKEN, s_token);
-  dict_write_cstring(iter, KEY_LIST_ID, list_id);
-  dict_write_cstring(iter, KEY_REMINDER_ID, reminder_id);
+  dict_write_uint16(iter, KEY_LIST_ID, s_rows_list);
+  dict_write_uint16(iter, KEY_HANDLE_EPOCH, s_handle_epoch);
+  dict_write_int(iter, KEY_BATCH_START, &start, sizeof(int), true);
+  dict_write_int(iter, KEY_COUNT, &count, sizeof(int), true);
+
+  if (app_message_outbox_send() == APP_MSG_OK) {
+    s_page_pending_start = start;
+    s_page_pending_end = start + count;
+  }
+}
+
+// Ask the phone for the first rows of a list that may be opened next.
+// Skipped when the outbox is busy; it is only a guess.
+static void send_prefetch_request(Handle list) {
+  DictionaryIterator *iter;
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    return;
+  }
+
+  dict_write_int(iter, KEY_CMD, &(int){CMD_PREFETCH_REMINDERS}, sizeof(int), true);
+  dict_write_cstring(iter, KEY_TOKEN, s_token);
+  dict_write_uint16(iter, KEY_LIST_ID, list);
+  dict_write_uint16(iter, KEY_HANDLE_EPOCH, s_handle_epoch);
 
   app_message_outbox_send();
 }
 
+static bool send_complete_reminder_request(Handle list, Handle reminder, uint16_t epoch) {
+  DictionaryIterator *iter;
+  if (app_message_outbox_begin(&iter) != APP_MSG_OK) {
+    return false;
+  }
+
+  dict_write_int(iter, KEY_CMD, &(int){CMD_COMPLETE_REMINDER}, sizeof(int), true);
+  dict_write_cstring(iter, KEY_TOKEN, s_token);
+  dict_write_uint16(iter, KEY_LIST_ID, list);
+  dict_write_uint16(iter, KEY_REMINDER_ID, reminder);
+  dict_write_uint16(iter, KEY_HANDLE_EPOCH, epoch);
+
+  return app_message_outbox_send() == APP_MSG_OK;
+}
+
 // Menu callbacks for lists
 static uint16_t menu_get_num_sections_callback(MenuLayer *menu_layer, void *data) {
   return 1;
@@ -321,48 +1570,100 @@ static void menu_draw_header_callback(GContext* ctx, const Layer *cell_layer, ui
 }
 
 static void menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
-  menu_cell_basic_draw(ctx, cell_layer, s_lists[cell_index->row].title, NULL, NULL);
+  menu_cell_basic_draw(ctx, cell_layer, arena_get(&s_list_arena, s_lists[cell_index->row].title), NULL, NULL);
 }
 
 static void menu_select_callback(MenuLayer *menu_layer, MenuIndex *cell_index, void *data) {
   // Selected a list - show reminders
+  Handle list = s_lists[cell_index->row].handle;
+  if (list == HANDLE_NONE) {
+    // Still arriving from the phone
+    return;
+  }
   s_current_list_index = cell_index->row;
+  if (s_prefetch_timer) {
+    app_timer_cancel(s_prefetch_timer);
+    s_prefetch_timer = NULL;
+  }
+
+  // Only keep showing the held rows if they belong to this list, or
+  // draw the prefetched ones. Otherwise drop the old list's rows and its
+  // token, so an exit before the reply cannot cache an empty list under it.
+  if (s_rows_list != list && !take_prefetched_rows(list)) {
+    clear_rows();
+  }
   show_reminders_window();
-  send_get_reminders_request(s_lists[s_current_list_index].id);
+  send_get_reminders_request(list);
+}
+
+// Prefetch the list the selection rests on; scrolling past sends nothing
+static void menu_selection_changed_callback(MenuLayer *menu_layer, MenuIndex new_index,
+                                            MenuIndex old_index, void *data) {
+  if (!s_prefetch_timer || !app_timer_reschedule(s_prefetch_timer, PREFETCH_DWELL_MS)) {
+    s_prefetch_timer = app_timer_register(PREFETCH_DWELL_MS, prefetch_timer_callback, NULL);
+  }
 }
 
 // Menu callbacks for reminders
 static uint16_t reminders_menu_get_num_rows_callback(MenuLayer *menu_layer, uint16_t section_index, void *data) {
-  return s_reminder_count;
+  return s_reminder_total;
 }
 
 static void reminders_menu_draw_header_callback(GContext* ctx, const Layer *cell_layer, uint16_t section_index, void *data) {
   if (s_current_list_index >= 0 && s_current_list_index < s_list_count) {
-    menu_cell_basic_header_draw(ctx, cell_layer, s_lists[s_current_list_index].title);
+    menu_cell_basic_header_draw(ctx, cell_layer, arena_get(&s_list_arena, s_lists[s_current_list_index].title));
   }
 }
 
 static void reminders_menu_draw_row_callback(GContext* ctx, const Layer *cell_layer, MenuIndex *cell_index, void *data) {
-  const char *subtitle = s_reminders[cell_index->row].completed ? "✓ Complete" : "Incomplete";
-  menu_cell_basic_draw(ctx, cell_layer, s_reminders[cell_index->row].title, subtitle, NULL);
+  // Paged out rows are fetched as the selection moves; draw a placeholder
+  Reminder *reminder = resident_reminder(cell_index->row);
+  if (!reminder || reminder->title == STR_NONE) {
+    menu_cell_basic_draw(ctx, cell_layer, "Loading...", NULL, NULL);
+    return;
+  }
+
+  const char *subtitle = reminder->completed ? "✓ Complete" : "Incomplete";
+  menu_cell_basic_draw(ctx, cell_layer, arena_get(&s_reminder_arena, reminder->title), subtitle, NULL);
+}
+
+// Page rows in from here rather than from drawing, which must not send.
+// Fetch the page around a selection that left the window, and prefetch
+// the next page before the selection reaches the window edge.
+static void reminders_menu_selection_changed_callback(MenuLayer *menu_layer, MenuIndex new_index,
+                                                      MenuIndex old_index, void *data) {
+  int window_end = s_window_start + s_reminder_count;
+  if (new_index.row < s_window_start || new_index.row >= window_end) {
+    send_get_reminder_page_request(new_index.row);
+  } else if (new_index.row > old_index.row && new_index.row + PREFETCH_MARGIN >= window_end) {
+    send_get_reminder_page_request(window_end);
+  } else if (new_index.row < old_index.row && new_index.row - PREFETCH_MARGIN < s_window_start) {
+    send_get_reminder_page_request(s_window_start - 1);
+  }
 }
 
 static void reminders_menu_select_callback(MenuLayer *menu_layer, MenuIndex *cell_index, void *data) {
   // Selected a reminder - show detail
+  Reminder *reminder = resident_reminder(cell_index->row);
+  if (!reminder || reminder->title == STR_NONE) {
+    return;
+  }
   s_current_reminder_index = cell_index->row;
   show_detail_window(cell_index->row);
 }
 
 // Detail window
 static void action_bar_click_handler(ClickRecognizerRef recognizer, void *context) {
-  // Complete button clicked
-  if (s_current_reminder_index >= 0 && s_current_reminder_index < s_reminder_count) {
-    if (!s_reminders[s_current_reminder_index].completed) {
-      send_complete_reminder_request(
-        s_reminders[s_current_reminder_index].list_id,
-        s_reminders[s_current_reminder_index].id
-      );
+  // Complete button clicked; the phone confirms in the background
+  Reminder *reminder = resident_reminder(s_current_reminder_index);
+  if (reminder && !reminder->completed) {
+    if (!outbox_add(s_rows_list, reminder)) {
+      // Too many completions still waiting for the phone
+      vibes_double_pulse();
+      return;
     }
+    window_stack_remove(s_detail_window, true);
+    mark_rows_dirty(&s_reminders_redraw, s_current_reminder_index, s_current_reminder_index + 1);
   }
 }
 
@@ -399,11 +1700,12 @@ static void show_detail_window(int reminder_index) {
   });
 
   // Set reminder text
-  if (reminder_index >= 0 && reminder_index < s_reminder_count) {
+  Reminder *reminder = resident_reminder(reminder_index);
+  if (reminder) {
     static char detail_text[256];
     snprintf(detail_text, sizeof(detail_text), "%s\n\n%s",
-             s_reminders[reminder_index].title,
-             s_reminders[reminder_index].completed ? "Status: Complete" : "Status: Incomplete\n\nPress SELECT to mark complete");
+             arena_get(&s_reminder_arena, reminder->title),
+             reminder->completed ? "Status: Complete" : "Status: Incomplete\n\nPress SELECT to mark complete");
     text_layer_set_text(s_detail_text_layer, detail_text);
   }
 
@@ -422,6 +1724,7 @@ static void reminders_window_load(Window *window) {
     .get_header_height = menu_get_header_height_callback,
     .draw_header = reminders_menu_draw_header_callback,
     .draw_row = reminders_menu_draw_row_callback,
+    .selection_changed = reminders_menu_selection_changed_callback,
     .select_click = reminders_menu_select_callback,
   });
 
@@ -482,6 +1785,7 @@ static void main_window_load(Window *window) {
     .get_header_height = menu_get_header_height_callback,
     .draw_header = menu_draw_header_callback,
     .draw_row = menu_draw_row_callback,
+    .selection_changed = menu_selection_changed_callback,
     .select_click = menu_select_callback,
   });
 
@@ -496,6 +1800,11 @@ static void main_window_unload(Window *window) {
 static void init(void) {
   // Load settings
   load_settings();
+  if (s_is_logged_in) {
+    load_cache();
+  }
+  load_outbox();
+  apply_outbox_to_rows();
 
   // Initialize AppMessage
   app_message_register_inbox_received(inbox_received_callback);
@@ -505,6 +1814,10 @@ static void init(void) {
 
   app_message_open(512, 512);
 
+  connection_service_subscribe((ConnectionHandlers) {
+    .pebble_app_connection_handler = phone_connection_handler
+  });
+
   // Create main window
   s_main_window = window_create();
   window_set_window_handlers(s_main_window, (WindowHandlers) {
@@ -515,6 +1828,8 @@ static void init(void) {
 
   // Check if logged in
   if (s_is_logged_in) {
+    // Cached lists are already drawn; this refreshes them in the background.
+    // Pending completions go out once the phone has answered.
     send_get_lists_request();
   } else {
     show_settings_window();
@@ -522,6 +1837,18 @@ static void init(void) {
 }
 
 static void deinit(void) {
+  connection_service_unsubscribe();
+  if (s_redraw_timer) {
+    app_timer_cancel(s_redraw_timer);
+  }
+  if (s_prefetch_timer) {
+    app_timer_cancel(s_prefetch_timer);
+  }
+  APP_LOG(APP_LOG_LEVEL_INFO, "Redraw: %d updates -> %d reloads, %d repaints, %d skipped",
+          s_redraw_updates, s_redraw_reloads, s_redraw_repaints, s_redraw_skipped);
+  if (s_is_logged_in) {
+    save_cache();
+  }
   window_destroy(s_main_window);
 }
 
@@ -17,17 +17,38 @@ var KEY_REMINDER_INDEX = 11;
 var KEY_STATUS = 12;
 var KEY_ERROR = 13;
 var KEY_COUNT = 14;
+var KEY_BATCH_START = 15;
+var KEY_BATCH = 16;
+var KEY_SYNC_TOKEN = 17;
+var KEY_HANDLE_EPOCH = 18;
 
 // Commands
 var CMD_LOGIN = 1;
 var CMD_GET_LISTS = 2;
 var CMD_GET_REMINDERS = 3;
 var CMD_COMPLETE_REMINDER = 4;
+var CMD_GET_REMINDER_PAGE = 5;
+var CMD_PREFETCH_REMINDERS = 6;
 
 // Status codes
 var STATUS_SUCCESS = 1;
 var STATUS_ERROR = 0;
 
+// KEY_ACTION on a failed CMD_COMPLETE_REMINDER: the watch keeps it queued
+var ACTION_RETRY = 1;
+
+// Batch limits - sized to fit the 512-byte inbox opened by the watch
+// alongside the CMD, STATUS and SYNC_TOKEN tuples
+var BATCH_VERSION = 2;
+var MAX_BATCH_BYTES = 400;
+var MAX_BATCH_HEADER_BYTES = 8;
+var MAX_LIST_TITLE_BYTES = 63;
+var MAX_REMINDER_TITLE_BYTES = 127;
+
+// Rows sent when the watch opens a list it holds nothing for; the rest
+// are paged in with CMD_GET_REMINDER_PAGE as the user scrolls
+var INITIAL_REMINDER_ROWS = 40;
+
 // Configuration - Fixed backend URL for production multi-tenant service
 // TODO: Update this URL when deploying to production
 var BACKEND_URL = 'https://pebble-icloud-api.up.railway.app'; // Production URL
@@ -37,22 +58,133 @@ var BACKEND_URL = 'https://pebble-icloud-api.up.railway.app'; // Production URL
 console.log('PebbleKit JS started');
 console.log('Backend URL: ' + BACKEND_URL);
 
+// Outbound message queue
+// Only one AppMessage is in flight at a time; the next one goes out when
+// the watch ACKs. NACKed messages are retried with exponential backoff.
+var PRIORITY_HIGH = 0;    // Errors and status/count headers
+var PRIORITY_NORMAL = 1;  // Row batches
+var PRIORITY_LOW = 2;     // Prefetches nobody is waiting on yet
+var MAX_SEND_ATTEMPTS = 6;
+var RETRY_BASE_DELAY_MS = 100;
+var RETRY_MAX_DELAY_MS = 3200;
+
+var sendQueues = [[], [], []];
+var sendInFlight = null;
+var sendRetryTimer = null;
+
+// Queue a message for the watch.
+// options.priority - PRIORITY_HIGH, PRIORITY_NORMAL (default) or PRIORITY_LOW
+// options.group    - tag used to drop the message if it is superseded
+// options.label    - description for logs
+function enqueueMessage(message, options) {
+  options = options || {};
+  var priority = options.priority === undefined ? PRIORITY_NORMAL : options.priority;
+
+  sendQueues[priority].push({
+    message: message,
+    priority: priority,
+    group: options.group || null,
+    label: options.label || 'message',
+    attempts: 0
+  });
+  pumpSendQueue();
+}
+
+// Drop queued messages belonging to a superseded response
+function cancelGroup(group) {
+  var dropped = 0;
+  sendQueues.forEach(function(queue, priority) {
+    sendQueues[priority] = queue.filter(function(entry) {
+      return entry.group !== group;
+    });
+    dropped += queue.length - sendQueues[priority].length;
+  });
+
+  if (sendInFlight && sendInFlight.group === group) {
+    sendInFlight.cancelled = true;
+  }
+  if (dropped > 0) {
+    console.log('Dropped ' + dropped + ' superseded ' + group + ' messages');
+  }
+}
+
+function nextQueuedMessage() {
+  for (var i = 0; i < sendQueues.length; i++) {
+    if (sendQueues[i].length > 0) {
+      return sendQueues[i].shift();
+    }
+  }
+  return null;
+}
+
+function pumpSendQueue() {
+  if (sendInFlight || sendRetryTimer) {
+    return;
+  }
+
+  var entry = nextQueuedMessage();
+  if (!entry) {
+    return;
+  }
+
+  sendInFlight = entry;
+  entry.attempts++;
+
+  Pebble.sendAppMessage(entry.message, function() {
+    sendInFlight = null;
+    console.log('Sent ' + entry.label);
+    pumpSendQueue();
+  }, function(e) {
+    sendInFlight = null;
+    var reason = e && e.error ? e.error.message : 'unknown error';
+
+    if (entry.cancelled || entry.attempts >= MAX_SEND_ATTEMPTS) {
+      console.log('Giving up on ' + entry.label + ' after ' + entry.attempts + ' attempts: ' + reason);
+
+      // The rest of this response is useless without the lost message
+      if (entry.group) {
+        cancelGroup(entry.group);
+      }
+      pumpSendQueue();
+      return;
+    }
+
+    var delay = Math.min(RETRY_BASE_DELAY_MS * Math.pow(2, entry.attempts - 1), RETRY_MAX_DELAY_MS);
+    console.log('Retrying ' + entry.label + ' in ' + delay + 'ms: ' + reason);
+
+    // Retry ahead of its priority class so rows stay in order
+    sendQueues[entry.priority].unshift(entry);
+    sendRetryTimer = setTimeout(function() {
+      sendRetryTimer = null;
+      pumpSendQueue();
+    }, delay);
+  });
+}
+
 // Helper function to send error to watch
-function sendError(cmd, error) {
+function sendError(cmd, error, data) {
   console.log('Sending error to watch: ' + error);
-  Pebble.sendAppMessage({
+  var message = {
     KEY_CMD: cmd,
     KEY_STATUS: STATUS_ERROR,
     KEY_ERROR: error
-  }, function() {
-    console.log('Error message sent successfully');
-  }, function(e) {
-    console.log('Failed to send error message: ' + e.error.message);
+  };
+
+  // Add additional data
+  for (var key in data) {
+    if (data.hasOwnProperty(key)) {
+      message[key] = data[key];
+    }
+  }
+
+  enqueueMessage(message, {
+    priority: PRIORITY_HIGH,
+    label: 'error message'
   });
 }
 
 // Helper function to send success to watch
-function sendSuccess(cmd, data) {
+function sendSuccess(cmd, data, group) {
   console.log('Sending success to watch');
   var message = {
     KEY_CMD: cmd,
@@ -66,10 +198,227 @@ function sendSuccess(cmd, data) {
     }
   }
 
-  Pebble.sendAppMessage(message, function() {
-    console.log('Success message sent');
-  }, function(e) {
-    console.log('Failed to send success message: ' + e.error.message);
+  enqueueMessage(message, {
+    priority: PRIORITY_HIGH,
+    group: group,
+    label: 'success message'
+  });
+}
+
+// Encode a string as UTF-8 bytes, truncated on a character boundary
+function utf8Bytes(str, maxBytes) {
+  var encoded = unescape(encodeURIComponent(str || ''));
+  var length = Math.min(encoded.length, maxBytes);
+
+  // Don't cut a multi-byte character in half
+  if (length < encoded.length) {
+    while (length > 0 && (encoded.charCodeAt(length) & 0xC0) === 0x80) {
+      length--;
+    }
+  }
+
+  var bytes = [];
+  for (var i = 0; i < length; i++) {
+    bytes.push(encoded.charCodeAt(i));
+  }
+  return bytes;
+}
+
+// Handle table
+// The watch names lists and reminders by uint16 handles rather than their
+// GUIDs. Handles are allocated here on first use and kept in localStorage,
+// so rows the watch has cached stay valid across PKJS restarts. A new
+// epoch (on login, or when the table has outgrown MAX_HANDLES) tells the
+// watch to drop every handle it holds. The previous epoch's table is kept
+// until the next one starts, so completions the watch queued before it
+// learned the new epoch still resolve.
+var HANDLES_STORAGE_KEY = 'pebble_icloud_handles';
+var MAX_HANDLES = 4096;
+var HANDLE_LIMIT = 0xFFFF;
+
+function newHandleTable(previous) {
+  var epoch;
+  do {
+    epoch = 1 + Math.floor(Math.random() * 0xFFFF);
+  } while (previous && epoch === previous.epoch);
+  return {
+    epoch: epoch,
+    ids: [null],  // Handle 0 means none
+    handles: {},
+    previous: previous || null,  // { epoch, ids }
+    dirty: true
+  };
+}
+
+function loadHandleTable() {
+  try {
+    var stored = JSON.parse(localStorage.getItem(HANDLES_STORAGE_KEY));
+    if (stored && stored.epoch && stored.ids) {
+      var table = {
+        epoch: stored.epoch,
+        ids: stored.ids,
+        handles: {},
+        previous: stored.previous || null,
+        dirty: false
+      };
+      for (var handle = 1; handle < table.ids.length; handle++) {
+        table.handles[table.ids[handle]] = handle;
+      }
+      return table;
+    }
+  } catch (e) {
+    console.log('Discarding unreadable handle table: ' + e);
+  }
+  return newHandleTable();
+}
+
+var handleTable = loadHandleTable();
+
+// Written once per response rather than per new handle
+function saveHandleTable() {
+  if (handleTable.dirty) {
+    handleTable.dirty = false;
+    localStorage.setItem(HANDLES_STORAGE_KEY, JSON.stringify({
+      epoch: handleTable.epoch,
+      ids: handleTable.ids,
+      previous: handleTable.previous
+    }));
+  }
+}
+
+function resetHandleTable() {
+  handleTable = newHandleTable({ epoch: handleTable.epoch, ids: handleTable.ids });
+  saveHandleTable();
+
+  // Queued rows carry old-epoch handles, and the new epoch's lists header
+  // would overtake them; once the watch adopts it those handles name
+  // other lists
+  cancelGroup('reminders');
+  cancelGroup('prefetch');
+}
+
+// Return the handle for a GUID, allocating one if needed. Returns 0 once
+// all handles are used up; such rows show but cannot be completed.
+function handleFor(id) {
+  var handle = handleTable.handles[id];
+  if (handle === undefined) {
+    if (handleTable.ids.length > HANDLE_LIMIT) {
+      return 0;
+    }
+    handle = handleTable.ids.length;
+    handleTable.ids.push(id);
+    handleTable.handles[id] = handle;
+    handleTable.dirty = true;
+  }
+  return handle;
+}
+
+// Map a handle from a watch request back to its GUID, or null if the
+// watch sent it under an unknown epoch or it was never allocated.
+// Pass allowPrevious for completions, which may predate the current epoch.
+function idForHandle(payload, key, allowPrevious) {
+  var handle = payload[key];
+  if (!(handle > 0)) {
+    return null;
+  }
+  if (payload.KEY_HANDLE_EPOCH === handleTable.epoch) {
+    return handleTable.ids[handle] || null;
+  }
+  var previous = handleTable.previous;
+  if (allowPrevious && previous && payload.KEY_HANDLE_EPOCH === previous.epoch) {
+    return previous.ids[handle] || null;
+  }
+  return null;
+}
+
+// Unsigned LEB128
+function varint(value) {
+  var bytes = [];
+  while (value >= 0x80) {
+    bytes.push((value & 0x7F) | 0x80);
+    value >>>= 7;
+  }
+  bytes.push(value);
+  return bytes;
+}
+
+// Batch items, as decoded by apply_*_batch in main.c:
+// Lists:     [handle][title length][title]
+// Reminders: [handle][title length << 1 | completed][title]
+function encodeList(list) {
+  var title = utf8Bytes(list.title, MAX_LIST_TITLE_BYTES);
+  return varint(handleFor(list.id))
+    .concat(varint(title.length))
+    .concat(title);
+}
+
+function encodeReminder(reminder) {
+  var title = utf8Bytes(reminder.title, MAX_REMINDER_TITLE_BYTES);
+  return varint(handleFor(reminder.id))
+    .concat(varint(title.length << 1 | (reminder.completed ? 1 : 0)))
+    .concat(title);
+}
+
+// Pack items into as few batches as fit the watch inbox.
+// Each batch holds batch.count encoded items covering consecutive rows
+// from batch.start. Pass indices to send only those rows.
+function packBatches(items, encodeItem, indices) {
+  var batches = [];
+  var current = null;
+
+  if (!indices) {
+    indices = items.map(function(item, index) {
+      return index;
+    });
+  }
+
+  indices.forEach(function(index) {
+    var encoded = encodeItem(items[index]);
+    var contiguous = current && current.start + current.count === index;
+    if (!contiguous || current.count === 255 ||
+        current.bytes.length + encoded.length > MAX_BATCH_BYTES - MAX_BATCH_HEADER_BYTES) {
+      current = { start: index, count: 0, bytes: [] };
+      batches.push(current);
+    }
+    current.count++;
+    Array.prototype.push.apply(current.bytes, encoded);
+  });
+
+  return batches;
+}
+
+// [version][count][start row][list handle][items], with listHandle 0 for
+// list batches
+function encodeBatch(batch, listHandle) {
+  return [BATCH_VERSION, batch.count]
+    .concat(varint(batch.start))
+    .concat(varint(listHandle))
+    .concat(batch.bytes);
+}
+
+// Queue packed batches for the watch, one message per batch.
+// lastExtra is merged into the final batch only.
+function sendBatches(cmd, batches, listHandle, group, lastExtra) {
+  saveHandleTable();
+
+  batches.forEach(function(batch, i) {
+    var message = {
+      KEY_CMD: cmd,
+      KEY_STATUS: STATUS_SUCCESS,
+      KEY_BATCH: encodeBatch(batch, listHandle)
+    };
+    if (i === batches.length - 1) {
+      for (var key in lastExtra) {
+        if (lastExtra.hasOwnProperty(key)) {
+          message[key] = lastExtra[key];
+        }
+      }
+    }
+
+    enqueueMessage(message, {
+      group: group,
+      label: 'batch ' + batch.start + '-' + (batch.start + batch.count - 1)
+    });
   });
 }
 
@@ -87,6 +436,10 @@ function handleLogin(username, appleId, applePassword) {
         var response = JSON.parse(xhr.responseText);
         console.log('Login successful, token: ' + response.token);
 
+        // Handles and responses from the previous account must not carry over
+        resetHandleTable();
+        clearResponseCache();
+
         // Send token back to watch
         sendSuccess(CMD_LOGIN, {
           KEY_TOKEN: response.token
@@ -128,6 +481,10 @@ function handleRegister(username, appleId, applePassword) {
         var response = JSON.parse(xhr.responseText);
         console.log('Registration successful, token: ' + response.token);
 
+        // Handles and responses from the previous account must not carry over
+        resetHandleTable();
+        clearResponseCache();
+
         // Send token back to watch
         sendSuccess(CMD_LOGIN, {
           KEY_TOKEN: response.token
@@ -156,134 +513,590 @@ function handleRegister(username, appleId, applePassword) {
   }));
 }
 
+// Response cache
+// The last lists and reminder snapshots are kept in localStorage per
+// token and list. A watch request is answered from a fresh entry at once,
+// even after a PKJS restart, and the backend is asked in the background.
+// Entries older than RESPONSE_CACHE_TTL_MS wait for the network instead,
+// though their ETags still let the backend answer with a 304.
+var RESPONSE_CACHE_PREFIX = 'pebble_icloud_cache:';
+var RESPONSE_CACHE_INDEX_KEY = 'pebble_icloud_cache_index';
+var RESPONSE_CACHE_TTL_MS = 15 * 60 * 1000;
+var RESPONSE_CACHE_MAX_ENTRIES = 12;
+
+// Cached keys, least recently used first, and the entries parsed so far
+// this session so page requests do not re-read storage
+var responseCacheIndex = loadResponseCacheIndex();
+var responseCacheMemory = {};
+
+function loadResponseCacheIndex() {
+  try {
+    return JSON.parse(localStorage.getItem(RESPONSE_CACHE_INDEX_KEY)) || [];
+  } catch (e) {
+    return [];
+  }
+}
+
+// FNV-1a, so the bearer token itself never ends up in a storage key
+function hashString(str) {
+  var hash = 0x811c9dc5;
+  for (var i = 0; i < str.length; i++) {
+    hash ^= str.charCodeAt(i);
+    hash = Math.imul(hash, 0x01000193) >>> 0;
+  }
+  return hash.toString(16);
+}
+
+// Key for a list's reminder snapshot, or for the lists when listId is omitted
+function cacheKey(token, listId) {
+  return RESPONSE_CACHE_PREFIX + hashString(token || '') + ':' + (listId || '');
+}
+
+function touchCacheKey(key) {
+  var position = responseCacheIndex.indexOf(key);
+  if (position >= 0) {
+    responseCacheIndex.splice(position, 1);
+  }
+  responseCacheIndex.push(key);
+}
+
+function cacheGet(key) {
+  var entry = responseCacheMemory[key] || null;
+  if (!entry) {
+    try {
+      entry = JSON.parse(localStorage.getItem(key));
+    } catch (e) {
+      console.log('Discarding unreadable cache entry: ' + e);
+    }
+  }
+  if (entry) {
+    responseCacheMemory[key] = entry;
+    touchCacheKey(key);
+    localStorage.setItem(RESPONSE_CACHE_INDEX_KEY, JSON.stringify(responseCacheIndex));
+  }
+  return entry;
+}
+
+function removeCacheEntry(key) {
+  localStorage.removeItem(key);
+  delete responseCacheMemory[key];
+}
+
+function cachePut(key, entry) {
+  var value = JSON.stringify(entry);
+  touchCacheKey(key);
+  responseCacheMemory[key] = entry;
+  while (responseCacheIndex.length > RESPONSE_CACHE_MAX_ENTRIES) {
+    removeCacheEntry(responseCacheIndex.shift());
+  }
+  for (;;) {
+    try {
+      localStorage.setItem(key, value);
+      break;
+    } catch (e) {
+      // Over quota; make room, but never by evicting the entry itself
+      if (responseCacheIndex[0] === key) {
+        console.log('Could not cache response: ' + e);
+        responseCacheIndex.pop();
+        removeCacheEntry(key);
+        break;
+      }
+      removeCacheEntry(responseCacheIndex.shift());
+    }
+  }
+  localStorage.setItem(RESPONSE_CACHE_INDEX_KEY, JSON.stringify(responseCacheIndex));
+}
+
+function clearResponseCache() {
+  responseCacheIndex.forEach(removeCacheEntry);
+  responseCacheIndex = [];
+  responseCacheMemory = {};
+  localStorage.removeItem(RESPONSE_CACHE_INDEX_KEY);
+}
+
+function isFresh(entry) {
+  return Date.now() - entry.fetchedAt < RESPONSE_CACHE_TTL_MS;
+}
+
+// Sequence numbers let a newer request supersede an older one still in flight
+var listsRequestSeq = 0;
+var remindersRequestSeq = 0;
+var prefetchRequestSeq = 0;
+
+// ETag of the lists last sent to the watch this session. The phone's
+// HTTP stack negotiates gzip itself; conditional requests are up to us.
+var watchListsEtag = null;
+
+// Send the watch a full set of lists
+function sendLists(lists, etag) {
+  cancelGroup('lists');
+
+  // The watch learns the epoch here, so this is the one place the
+  // table may start over
+  if (handleTable.ids.length > MAX_HANDLES) {
+    console.log('Handle table full, starting a new epoch');
+    resetHandleTable();
+  }
+  var batches = packBatches(lists, encodeList);
+
+  // Send count first
+  sendSuccess(CMD_GET_LISTS, {
+    KEY_COUNT: lists.length,
+    KEY_HANDLE_EPOCH: handleTable.epoch
+  }, 'lists');
+
+  // Send lists packed into batches
+  sendBatches(CMD_GET_LISTS, batches, 0, 'lists');
+  watchListsEtag = etag;
+}
+
 // Handle get lists request
 function handleGetLists(token) {
   console.log('Getting reminder lists');
+  var seq = ++listsRequestSeq;
+  var key = cacheKey(token);
+  var cached = cacheGet(key);
+
+  // Answer from the cache, then check it is still current
+  var answered = false;
+  if (cached && isFresh(cached)) {
+    console.log('Sending ' + cached.lists.length + ' cached lists');
+    sendLists(cached.lists, cached.etag);
+    answered = true;
+  }
+
+  // Once the watch has lists, only a rejected token is worth telling it about
+  function fail(error) {
+    if (answered) {
+      console.log('Revalidating cached lists failed: ' + error);
+    } else {
+      sendError(CMD_GET_LISTS, error);
+    }
+  }
 
   var xhr = new XMLHttpRequest();
   xhr.open('GET', BACKEND_URL + '/api/reminders/lists', true);
   xhr.setRequestHeader('Authorization', 'Bearer ' + token);
+  if (cached && cached.etag) {
+    xhr.setRequestHeader('If-None-Match', cached.etag);
+  }
 
   xhr.onload = function() {
-    if (xhr.status === 200) {
+    if (seq !== listsRequestSeq) {
+      console.log('Ignoring superseded lists response');
+      return;
+    }
+
+    if (xhr.status === 304 && cached) {
+      cached.fetchedAt = Date.now();
+      cachePut(key, cached);
+      if (answered) {
+        console.log('Cached lists still current');
+      } else if (cached.etag === watchListsEtag) {
+        // The watch already holds these lists. The header alone still
+        // tells it the phone is reachable, so it replays queued completions.
+        console.log('Lists unchanged');
+        sendSuccess(CMD_GET_LISTS, {
+          KEY_COUNT: cached.lists.length,
+          KEY_HANDLE_EPOCH: handleTable.epoch
+        }, 'lists');
+      } else {
+        sendLists(cached.lists, cached.etag);
+      }
+    } else if (xhr.status === 200) {
       try {
         var response = JSON.parse(xhr.responseText);
         var lists = response.lists || [];
+        var etag = xhr.getResponseHeader('ETag');
 
         console.log('Received ' + lists.length + ' lists');
-
-        // Send count first
-        sendSuccess(CMD_GET_LISTS, {
-          KEY_COUNT: lists.length
-        });
-
-        // Send each list individually
-        lists.forEach(function(list, index) {
-          Pebble.sendAppMessage({
-            KEY_REMINDER_INDEX: index,
-            KEY_LIST_ID: list.id,
-            KEY_LIST_TITLE: list.title
-          }, function() {
-            console.log('Sent list ' + index + ': ' + list.title);
-          }, function(e) {
-            console.log('Failed to send list ' + index + ': ' + e.error.message);
-          });
-        });
+        cachePut(key, { lists: lists, etag: etag, fetchedAt: Date.now() });
+        sendLists(lists, etag);
       } catch (e) {
-        sendError(CMD_GET_LISTS, 'Failed to parse lists response');
+        fail('Failed to parse lists response');
       }
     } else if (xhr.status === 401) {
       sendError(CMD_GET_LISTS, 'Authentication failed. Please login again.');
     } else {
-      sendError(CMD_GET_LISTS, 'Failed to get lists: ' + xhr.status);
+      fail('Failed to get lists: ' + xhr.status);
     }
   };
 
   xhr.onerror = function() {
-    sendError(CMD_GET_LISTS, 'Network error getting lists');
+    fail('Network error getting lists');
   };
 
   xhr.send();
 }
 
-// Handle get reminders request
-function handleGetReminders(token, listId) {
-  console.log('Getting reminders for list: ' + listId);
+// Apply a change feed to a copy of a reminders array
+function applyChanges(reminders, changes) {
+  var result = reminders.slice();
+
+  changes.forEach(function(change) {
+    var id = change.type === 'deleted' ? change.id : change.reminder.id;
+    var position = -1;
+    for (var i = 0; i < result.length; i++) {
+      if (result[i].id === id) {
+        position = i;
+        break;
+      }
+    }
+
+    if (change.type === 'deleted') {
+      if (position >= 0) {
+        result.splice(position, 1);
+      }
+    } else if (position >= 0) {
+      result[position] = change.reminder;
+    } else {
+      result.push(change.reminder);
+    }
+  });
+
+  return result;
+}
+
+function sameRow(a, b) {
+  return a && b && a.id === b.id && a.title === b.title && !!a.completed === !!b.completed;
+}
+
+// Send the watch's window of reminders. When previous holds the rows the
+// watch already has, only rows that differ are sent. The window may reach
+// past the rows the watch holds (a prefetch sends only a few), and those
+// always go out.
+function sendReminderRows(listHandle, reminders, previous, syncToken, windowStart, windowCount) {
+  var start = Math.min(windowStart || 0, reminders.length);
+  var held = start + (windowCount || 0);
+  var end = Math.min(start + Math.max(windowCount || 0, INITIAL_REMINDER_ROWS), reminders.length);
+  var changed = [];
+  for (var index = start; index < end; index++) {
+    if (!previous || index >= held || !sameRow(previous[index], reminders[index])) {
+      changed.push(index);
+    }
+  }
+  console.log('Sending ' + changed.length + ' of ' + reminders.length + ' reminders');
+
+  var batches = packBatches(reminders, encodeReminder, changed);
+  var header = {
+    KEY_COUNT: reminders.length,
+    KEY_LIST_ID: listHandle
+  };
+
+  // The watch adopts the sync token once the last row has arrived
+  if (batches.length === 0) {
+    header.KEY_SYNC_TOKEN = syncToken;
+  }
+  sendSuccess(CMD_GET_REMINDERS, header, 'reminders');
+  sendBatches(CMD_GET_REMINDERS, batches, listHandle, 'reminders', {
+    KEY_SYNC_TOKEN: syncToken
+  });
+}
+
+// Bring a list's snapshot up to date with the backend's change feed.
+// callback(error, latest) gets the current snapshot, the cached one when
+// nothing changed; error.status is 0 for a network error.
+function revalidateSnapshot(token, listId, snapshot, callback) {
+  var key = cacheKey(token, listId);
+
+  // The watch only shows these, so skip serializing the rest
+  var url = BACKEND_URL + '/api/reminders/changes?fields=id,title,completed&list_id=' +
+    encodeURIComponent(listId);
+  if (snapshot) {
+    url += '&since=' + encodeURIComponent(snapshot.token);
+  }
 
   var xhr = new XMLHttpRequest();
-  xhr.open('GET', BACKEND_URL + '/api/reminders/list/' + encodeURIComponent(listId), true);
+  xhr.open('GET', url, true);
   xhr.setRequestHeader('Authorization', 'Bearer ' + token);
+  if (snapshot && snapshot.etag) {
+    xhr.setRequestHeader('If-None-Match', snapshot.etag);
+  }
 
   xhr.onload = function() {
-    if (xhr.status === 200) {
+    if (xhr.status === 304 && snapshot) {
+      // Nothing changed since the snapshot; skip parsing entirely
+      console.log('Reminders unchanged');
+      snapshot.fetchedAt = Date.now();
+      cachePut(key, snapshot);
+      callback(null, snapshot);
+    } else if (xhr.status === 200) {
+      var latest;
       try {
         var response = JSON.parse(xhr.responseText);
-        var reminders = response.reminders || [];
-
-        console.log('Received ' + reminders.length + ' reminders');
-
-        // Send count first
-        sendSuccess(CMD_GET_REMINDERS, {
-          KEY_COUNT: reminders.length
-        });
+        var reminders;
+
+        if (response.reset || !snapshot) {
+          reminders = response.reminders || [];
+          console.log('Received ' + reminders.length + ' reminders');
+        } else {
+          reminders = applyChanges(snapshot.reminders, response.changes || []);
+          console.log('Applied ' + (response.changes || []).length + ' changes');
+        }
 
-        // Send each reminder individually
-        reminders.forEach(function(reminder, index) {
-          Pebble.sendAppMessage({
-            KEY_REMINDER_INDEX: index,
-            KEY_REMINDER_ID: reminder.id,
-            KEY_REMINDER_TITLE: reminder.title,
-            KEY_LIST_ID: listId,
-            KEY_REMINDER_COMPLETED: reminder.completed ? 1 : 0
-          }, function() {
-            console.log('Sent reminder ' + index + ': ' + reminder.title);
-          }, function(e) {
-            console.log('Failed to send reminder ' + index + ': ' + e.error.message);
-          });
-        });
+        latest = {
+          token: response.token,
+          reminders: reminders,
+          etag: xhr.getResponseHeader('ETag'),
+          fetchedAt: Date.now()
+        };
       } catch (e) {
-        sendError(CMD_GET_REMINDERS, 'Failed to parse reminders response');
+        callback({ status: xhr.status, message: 'Failed to parse reminders response' });
+        return;
       }
-    } else if (xhr.status === 401) {
-      sendError(CMD_GET_REMINDERS, 'Authentication failed. Please login again.');
+      cachePut(key, latest);
+      callback(null, latest);
     } else {
-      sendError(CMD_GET_REMINDERS, 'Failed to get reminders: ' + xhr.status);
+      callback({ status: xhr.status, message: 'Failed to get reminders: ' + xhr.status });
     }
   };
 
   xhr.onerror = function() {
-    sendError(CMD_GET_REMINDERS, 'Network error getting reminders');
+    callback({ status: 0, message: 'Network error getting reminders' });
   };
 
   xhr.send();
 }
 
-// Handle complete reminder request
-function handleCompleteReminder(token, listId, reminderId) {
-  console.log('Completing reminder: ' + reminderId + ' in list: ' + listId);
+// Handle get reminders request.
+// watchSyncToken identifies the rows the watch already holds for this list,
+// and windowStart/windowCount which of the list's rows those are.
+function handleGetReminders(token, listId, watchSyncToken, windowStart, windowCount) {
+  console.log('Getting reminders for list: ' + listId);
+  var seq = ++remindersRequestSeq;
+  var epoch = handleTable.epoch;
+  var snapshot = cacheGet(cacheKey(token, listId));
+
+  // Rows still queued for a previously opened list are no longer wanted
+  cancelGroup('reminders');
+
+  // Rows the watch holds from this snapshot are not sent again
+  var watchRows = null;
+  if (snapshot && watchSyncToken && watchSyncToken === snapshot.token) {
+    watchRows = snapshot.reminders;
+  }
+
+  // Answer from the cache; the watch then holds the snapshot, and only
+  // what the backend changed since goes out after it
+  var answered = false;
+  if (snapshot && isFresh(snapshot)) {
+    console.log('Answering from cached snapshot');
+    sendReminderRows(handleFor(listId), snapshot.reminders, watchRows, snapshot.token,
+      windowStart, windowCount);
+    watchRows = snapshot.reminders;
+    windowCount = Math.max(windowCount || 0, INITIAL_REMINDER_ROWS);
+    answered = true;
+  }
+
+  revalidateSnapshot(token, listId, snapshot, function(error, latest) {
+    if (seq !== remindersRequestSeq || epoch !== handleTable.epoch) {
+      console.log('Ignoring superseded reminders response');
+      return;
+    }
+
+    if (error && error.status === 401) {
+      sendError(CMD_GET_REMINDERS, 'Authentication failed. Please login again.');
+    } else if (error) {
+      if (answered) {
+        console.log('Revalidating cached reminders failed: ' + error.message);
+      } else {
+        sendError(CMD_GET_REMINDERS, error.message);
+      }
+    } else if (answered && latest.token === snapshot.token) {
+      console.log('Cached reminders still current');
+    } else {
+      sendReminderRows(handleFor(listId), latest.reminders, watchRows, latest.token,
+        windowStart, windowCount);
+    }
+  });
+}
+
+// Handle a prefetch for the list the watch's selection rests on. Only the
+// first batch of rows is sent, as one low-priority message the watch keeps
+// until the list is opened; failures are not worth telling it about.
+function handlePrefetchReminders(token, listId) {
+  var seq = ++prefetchRequestSeq;
+  var epoch = handleTable.epoch;
+  var snapshot = cacheGet(cacheKey(token, listId));
+
+  if (snapshot && isFresh(snapshot)) {
+    sendPrefetchedRows(listId, snapshot);
+    return;
+  }
+
+  console.log('Prefetching reminders for list: ' + listId);
+  revalidateSnapshot(token, listId, snapshot, function(error, latest) {
+    if (seq !== prefetchRequestSeq || epoch !== handleTable.epoch) {
+      return;
+    }
+    if (error) {
+      console.log('Prefetch failed: ' + error.message);
+      return;
+    }
+    sendPrefetchedRows(listId, latest);
+  });
+}
+
+function sendPrefetchedRows(listId, snapshot) {
+  var indices = [];
+  for (var index = 0; index < Math.min(snapshot.reminders.length, INITIAL_REMINDER_ROWS); index++) {
+    indices.push(index);
+  }
+  var batch = packBatches(snapshot.reminders, encodeReminder, indices)[0] ||
+    { start: 0, count: 0, bytes: [] };
+  console.log('Prefetched ' + batch.count + ' of ' + snapshot.reminders.length + ' reminders');
+
+  // Only the latest guess is worth the bandwidth
+  saveHandleTable();
+  cancelGroup('prefetch');
+  enqueueMessage({
+    KEY_CMD: CMD_PREFETCH_REMINDERS,
+    KEY_STATUS: STATUS_SUCCESS,
+    KEY_COUNT: snapshot.reminders.length,
+    KEY_SYNC_TOKEN: snapshot.token,
+    KEY_BATCH: encodeBatch(batch, handleFor(listId))
+  }, {
+    priority: PRIORITY_LOW,
+    group: 'prefetch',
+    label: 'prefetch'
+  });
+}
+
+// Handle a page request from a watch scrolling outside its resident rows.
+// Pages come from the same snapshot as the rows the watch already holds.
+function handleGetReminderPage(token, listId, start, count) {
+  var snapshot = cacheGet(cacheKey(token, listId));
+  if (!snapshot) {
+    // Nothing cached (evicted, or a new token); sync the list around the page
+    handleGetReminders(token, listId, null, start, count);
+    return;
+  }
+
+  var end = Math.min(start + count, snapshot.reminders.length);
+  var indices = [];
+  for (var index = start; index < end; index++) {
+    indices.push(index);
+  }
+  if (indices.length === 0) {
+    sendError(CMD_GET_REMINDER_PAGE, 'Page out of range');
+    return;
+  }
+  console.log('Sending reminder page ' + start + '-' + (end - 1));
+
+  sendBatches(CMD_GET_REMINDER_PAGE, packBatches(snapshot.reminders, encodeReminder, indices),
+    handleFor(listId), 'reminders');
+}
+
+// Completions are collected for a short while and sent to the backend as
+// one batch, which saves each iCloud list once however many items it has
+var COMPLETE_BATCH_DELAY_MS = 250;
+var MAX_COMPLETE_BATCH = 100;
+var pendingCompletions = [];
+var completionTimer = null;
+
+// Handle complete reminder request.
+// The watch already shows the reminder as complete and keeps it queued
+// until it hears back. Replies echo the reminder handle and its epoch;
+// failures that may succeed later are marked ACTION_RETRY, anything else
+// rolls it back.
+function handleCompleteReminder(token, listId, reminderId, reminderHandle, epoch) {
+  console.log('Queueing completion: ' + reminderId + ' in list: ' + listId);
+
+  pendingCompletions.push({
+    token: token,
+    list_id: listId,
+    reminder_id: reminderId,
+    reminder_handle: reminderHandle,
+    epoch: epoch
+  });
+
+  if (pendingCompletions.length >= MAX_COMPLETE_BATCH) {
+    flushCompletions();
+  } else if (!completionTimer) {
+    completionTimer = setTimeout(flushCompletions, COMPLETE_BATCH_DELAY_MS);
+  }
+}
+
+function sendCompletionResult(reminderHandle, epoch, error, retry) {
+  var data = {
+    KEY_REMINDER_ID: reminderHandle,
+    KEY_HANDLE_EPOCH: epoch
+  };
+  if (!error) {
+    sendSuccess(CMD_COMPLETE_REMINDER, data);
+    return;
+  }
+  if (retry) {
+    data.KEY_ACTION = ACTION_RETRY;
+  }
+  sendError(CMD_COMPLETE_REMINDER, error, data);
+}
+
+function flushCompletions() {
+  if (completionTimer) {
+    clearTimeout(completionTimer);
+    completionTimer = null;
+  }
+  var batch = pendingCompletions.splice(0, MAX_COMPLETE_BATCH);
+  if (batch.length === 0) {
+    return;
+  }
+  if (pendingCompletions.length > 0) {
+    completionTimer = setTimeout(flushCompletions, COMPLETE_BATCH_DELAY_MS);
+  }
+  console.log('Completing ' + batch.length + ' reminders');
 
   var xhr = new XMLHttpRequest();
-  xhr.open('POST', BACKEND_URL + '/api/reminders/' + encodeURIComponent(reminderId) + '/complete', true);
-  xhr.setRequestHeader('Authorization', 'Bearer ' + token);
+  xhr.open('POST', BACKEND_URL + '/api/reminders/complete-batch', true);
+  xhr.setRequestHeader('Authorization', 'Bearer ' + batch[batch.length - 1].token);
   xhr.setRequestHeader('Content-Type', 'application/json');
 
+  function failAll(error, retry) {
+    batch.forEach(function(item) {
+      sendCompletionResult(item.reminder_handle, item.epoch, error, retry);
+    });
+  }
+
   xhr.onload = function() {
     if (xhr.status === 200) {
-      console.log('Reminder completed successfully');
-      sendSuccess(CMD_COMPLETE_REMINDER, {});
-    } else if (xhr.status === 401) {
-      sendError(CMD_COMPLETE_REMINDER, 'Authentication failed. Please login again.');
+      var response;
+      try {
+        response = JSON.parse(xhr.responseText);
+      } catch (e) {
+        failAll('Failed to parse completion response', true);
+        return;
+      }
+      // One result per item, in order. A reminder may be queued under two
+      // epochs, so results are matched by position rather than GUID.
+      (response.results || []).forEach(function(result, i) {
+        var item = batch[i];
+        if (!item || item.reminder_id !== result.reminder_id) {
+          return;
+        }
+        if (result.status === 'completed') {
+          sendCompletionResult(item.reminder_handle, item.epoch);
+        } else {
+          // A failed save may work next time; a missing reminder will not
+          sendCompletionResult(item.reminder_handle, item.epoch,
+            'Failed to complete reminder: ' + (result.error || result.status),
+            result.status === 'error');
+        }
+      });
+    } else if (xhr.status === 401 || xhr.status === 429 || xhr.status >= 500) {
+      failAll('Failed to complete reminder: ' + xhr.status, true);
     } else {
-      sendError(CMD_COMPLETE_REMINDER, 'Failed to complete reminder: ' + xhr.status);
+      failAll('Failed to complete reminder: ' + xhr.status, false);
     }
   };
 
   xhr.onerror = function() {
-    sendError(CMD_COMPLETE_REMINDER, 'Network error completing reminder');
+    failAll('Network error completing reminder', true);
   };
 
   xhr.send(JSON.stringify({
-    list_id: listId
+    items: batch.map(function(item) {
+      return { list_id: item.list_id, reminder_id: item.reminder_id };
+    })
   }));
 }
 
@@ -309,15 +1122,47 @@ Pebble.addEventListener('appmessage', function(e) {
 
     case CMD_GET_REMINDERS:
       var token = e.payload.KEY_TOKEN;
-      var listId = e.payload.KEY_LIST_ID;
-      handleGetReminders(token, listId);
+      var listId = idForHandle(e.payload, 'KEY_LIST_ID');
+      if (!listId) {
+        // The watch holds handles from another epoch; resend the lists
+        sendError(CMD_GET_REMINDERS, 'List not found. Refreshing lists.');
+        handleGetLists(token);
+        break;
+      }
+      handleGetReminders(token, listId, e.payload.KEY_SYNC_TOKEN,
+        e.payload.KEY_BATCH_START, e.payload.KEY_COUNT);
+      break;
+
+    case CMD_GET_REMINDER_PAGE:
+      var token = e.payload.KEY_TOKEN;
+      var listId = idForHandle(e.payload, 'KEY_LIST_ID');
+      if (!listId) {
+        sendError(CMD_GET_REMINDER_PAGE, 'List not found');
+        break;
+      }
+      handleGetReminderPage(token, listId, e.payload.KEY_BATCH_START, e.payload.KEY_COUNT);
+      break;
+
+    case CMD_PREFETCH_REMINDERS:
+      var token = e.payload.KEY_TOKEN;
+      var listId = idForHandle(e.payload, 'KEY_LIST_ID');
+      if (listId) {
+        handlePrefetchReminders(token, listId);
+      }
       break;
 
     case CMD_COMPLETE_REMINDER:
       var token = e.payload.KEY_TOKEN;
-      var listId = e.payload.KEY_LIST_ID;
-      var reminderId = e.payload.KEY_REMINDER_ID;
-      handleCompleteReminder(token, listId, reminderId);
+      var listId = idForHandle(e.payload, 'KEY_LIST_ID', true);
+      var reminderId = idForHandle(e.payload, 'KEY_REMINDER_ID', true);
+      if (!listId || !reminderId) {
+        // Not retried, so the watch rolls the row back
+        sendCompletionResult(e.payload.KEY_REMINDER_ID, e.payload.KEY_HANDLE_EPOCH,
+          'Reminder not found', false);
+        break;
+      }
+      handleCompleteReminder(token, listId, reminderId, e.payload.KEY_REMINDER_ID,
+        e.payload.KEY_HANDLE_EPOCH);
       break;
 
     default: